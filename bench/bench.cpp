@@ -0,0 +1,265 @@
+#include "gif2ascii.hpp"
+#include "lzw.hpp"
+#include "synthgif.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+    Decode and render benchmark over synthetic GIFs generated in memory.
+    The three stages are timed on their own:
+        lzw         LZW::Decompress over every frame's code stream
+        frame_map   GIF::Read() of the whole file on one thread (parsing, decoding and GIF::GenerateFrameMap)
+        render      FrameRenderer::Render() of every frame, frames are decoded outside of the timed part
+    Results are printed as JSON so runs of different versions can be compared
+*/
+
+#define BENCH_DEFAULT_REPEAT    3
+#define BENCH_FORMAT_VERSION    1
+
+// Every heap allocation made by the process, the library included since it is linked in statically
+static std::atomic<size_t> gAllocations(0);
+
+void* operator new(size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+using Clock = std::chrono::steady_clock;
+
+// Best of the repeated runs of a stage, the other runs only add noise from the rest of the system
+struct StageResult {
+    double  Seconds     = 0;
+    size_t  Bytes       = 0;    // Bytes the stage produced in one run
+    size_t  Frames      = 0;
+    size_t  Allocations = 0;    // Heap allocations of the fastest run
+};
+
+struct BenchOptions {
+    unsigned int    Repeat  = BENCH_DEFAULT_REPEAT;
+    uint16_t        Columns = 0;
+    uint16_t        Rows    = 0;
+    CellMode        Cells   = CellMode::Glyph;
+    const char*     Output  = nullptr;
+    const char*     SaveDir = nullptr;
+    const char*     Filter  = nullptr;
+};
+
+// The corpus, covers small and large screens, palette and code sizes, interlacing and local tables
+static const SynthSpec CORPUS[] = {
+    // Name                     Width  Height  Frames  Colors  MinCode  Interlaced  Local  Fill               Seed
+    {"noise_64x64_16",          64,    64,     200,    16,     0,       false,      false, Pattern::Noise,    1},
+    {"noise_320x240_256",       320,   240,    60,     256,    0,       false,      false, Pattern::Noise,    2},
+    {"noise_800x600_256",       800,   600,    12,     256,    0,       false,      false, Pattern::Noise,    3},
+    {"gradient_320x240_256",    320,   240,    60,     256,    0,       false,      false, Pattern::Gradient, 4},
+    {"gradient_640x480_16",     640,   480,    30,     16,     0,       false,      false, Pattern::Gradient, 5},
+    {"bilevel_320x240_2",       320,   240,    60,     2,      0,       false,      false, Pattern::Noise,    6},
+    {"widecode_320x240_4",      320,   240,    60,     4,      8,       false,      false, Pattern::Noise,    7},
+    {"interlaced_320x240_256",  320,   240,    60,     256,    0,       true,       false, Pattern::Noise,    8},
+    {"interlaced_640x480_64",   640,   480,    20,     64,     0,       true,       false, Pattern::Gradient, 9},
+    {"local_320x240_64",        320,   240,    60,     64,     0,       false,      true,  Pattern::Noise,    10},
+    {"local_interlaced_320x240_256", 320, 240, 60,     256,    0,       true,       true,  Pattern::Gradient, 11},
+    {"sprite_480x360_256",      480,   360,    500,    256,    0,       false,      false, Pattern::Sprite,   12},
+};
+
+static void KeepFastest(StageResult* best, const StageResult& run)
+{
+    if (best->Frames == 0 || run.Seconds < best->Seconds)
+        *best = run;
+}
+
+static StageResult BenchLZW(const SynthGif& gif)
+{
+    ImageDataHeader header = {};
+    header.LZWMinimum = gif.MinCodeSize();
+
+    size_t largest = 0;
+    for (size_t i = 0; i < gif.FrameCount(); i++)
+        largest = (gif.FramePixels(i) > largest) ? gif.FramePixels(i) : largest;
+
+    std::vector<uint8_t> output(largest);
+
+    StageResult result;
+    size_t allocations = gAllocations.load();
+    Clock::time_point start = Clock::now();
+
+    for (size_t i = 0; i < gif.FrameCount(); i++) {
+        const std::vector<uint8_t>& codestream = gif.Codestream(i);
+        result.Bytes += LZW::Decompress(header, codestream.data(), codestream.size(), output.data(), gif.FramePixels(i));
+    }
+
+    result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.Allocations = gAllocations.load() - allocations;
+    result.Frames = gif.FrameCount();
+    return result;
+}
+
+static StageResult BenchFrameMap(const SynthGif& gif, ArenaStats* arena)
+{
+    StageResult result;
+    size_t allocations = gAllocations.load();
+    Clock::time_point start = Clock::now();
+
+    GIF decoded(gif.Data(), gif.Size());
+    decoded.Read();
+
+    result.Seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.Allocations = gAllocations.load() - allocations;
+    result.Frames = decoded.FrameCount();
+    result.Bytes = result.Frames * decoded.mLsd.Width * decoded.mLsd.Height;
+    *arena = decoded.DecodeStats();
+    return result;
+}
+
+static StageResult BenchRender(const SynthGif& gif, const BenchOptions& options)
+{
+    GifDecoder decoder(gif.Data(), gif.Size());
+
+    RenderOptions renderOptions;
+    renderOptions.Columns = options.Columns;
+    renderOptions.Rows = options.Rows;
+    renderOptions.Cells = options.Cells;
+    FrameRenderer renderer(decoder, renderOptions);
+
+    // Output is rendered into the same buffer every frame, so one frame up front sizes it
+    std::string output;
+    renderer.Render(decoder.Frame(0), &output);
+    renderer.Invalidate();
+
+    StageResult result;
+    size_t allocations = 0;
+    Clock::duration elapsed = Clock::duration::zero();
+
+    for (const FrameView& frame : decoder) {
+        size_t before = gAllocations.load();
+        Clock::time_point start = Clock::now();
+
+        renderer.Render(frame, &output);
+
+        elapsed += Clock::now() - start;
+        allocations += gAllocations.load() - before;
+        result.Bytes += output.size();
+        result.Frames++;
+    }
+
+    result.Seconds = std::chrono::duration<double>(elapsed).count();
+    result.Allocations = allocations;
+    return result;
+}
+
+static void PrintStage(FILE* out, const char* name, const StageResult& stage, bool last)
+{
+    double seconds = (stage.Seconds > 0) ? stage.Seconds : 1e-9;
+    fprintf(out, "      \"%s\": {\"seconds\": %.6f, \"mb_per_s\": %.2f, \"frames_per_s\": %.1f, \"bytes\": %zu, \"frames\": %zu, \"allocations\": %zu}%s\n",
+        name, stage.Seconds, stage.Bytes / seconds / (1024.0 * 1024.0), stage.Frames / seconds,
+        stage.Bytes, stage.Frames, stage.Allocations, last ? "" : ",");
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--repeat N] [--columns N] [--rows N] [--half] [--only NAME] [--save DIR] [--out FILE]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            options.Repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc)
+            options.Columns = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+            options.Rows = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--half") == 0)
+            options.Cells = CellMode::HalfBlock;
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc)
+            options.Filter = argv[++i];
+        else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc)
+            options.SaveDir = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            options.Output = argv[++i];
+        else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.Repeat == 0)
+        options.Repeat = 1;
+
+    FILE* out = stdout;
+    if (options.Output && !(out = fopen(options.Output, "w"))) {
+        fprintf(stderr, "Could not open %s\n", options.Output);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"version\": %d,\n  \"repeat\": %u,\n  \"columns\": %u,\n  \"rows\": %u,\n  \"half\": %s,\n  \"results\": [",
+        BENCH_FORMAT_VERSION, options.Repeat, options.Columns, options.Rows,
+        (options.Cells == CellMode::HalfBlock) ? "true" : "false");
+
+    bool first = true;
+    for (const SynthSpec& spec : CORPUS) {
+        if (options.Filter && !strstr(spec.Name.c_str(), options.Filter))
+            continue;
+
+        fprintf(stderr, "%s\n", spec.Name.c_str());
+        SynthGif gif(spec);
+
+        if (options.SaveDir) {
+            std::string path = std::string(options.SaveDir) + "/" + spec.Name + ".gif";
+            if (!gif.Save(path.c_str()))
+                fprintf(stderr, "Could not write %s\n", path.c_str());
+        }
+
+        StageResult lzw;
+        StageResult frameMap;
+        StageResult render;
+        ArenaStats arena = {};
+
+        try {
+            for (unsigned int run = 0; run < options.Repeat; run++) {
+                KeepFastest(&lzw, BenchLZW(gif));
+                KeepFastest(&frameMap, BenchFrameMap(gif, &arena));
+                KeepFastest(&render, BenchRender(gif, options));
+            }
+        } catch (const GifError& e) {
+            fprintf(stderr, "%s: %s\n", spec.Name.c_str(), e.what());
+            continue;
+        }
+
+        const SynthSpec& shape = gif.Spec();
+        fprintf(out, "%s\n    {\n", first ? "" : ",");
+        fprintf(out, "      \"name\": \"%s\", \"width\": %u, \"height\": %u, \"frames\": %zu, \"colors\": %u, \"min_code_size\": %u,\n",
+            shape.Name.c_str(), shape.Width, shape.Height, gif.FrameCount(), shape.Colors, gif.MinCodeSize());
+        fprintf(out, "      \"interlaced\": %s, \"local_tables\": %s, \"file_bytes\": %zu, \"arena_allocations\": %zu,\n",
+            shape.Interlaced ? "true" : "false", shape.LocalTables ? "true" : "false", gif.Size(), arena.Allocations);
+        PrintStage(out, "lzw", lzw, false);
+        PrintStage(out, "frame_map", frameMap, false);
+        PrintStage(out, "render", render, true);
+        fprintf(out, "    }");
+        first = false;
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout)
+        fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef _SYNTHGIF_HPP
+#define _SYNTHGIF_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// What the frames of a synthetic GIF are filled with, which decides how well they compress
+enum class Pattern {
+    Noise,      // Random indices, almost every code is a root entry and the table fills quickly
+    Gradient,   // Moving diagonal bands, long runs that grow codes up to 12 bits
+    Sprite      // Still background with a small block moving over it, frames only cover the block
+};
+
+// Shape of a synthetic GIF
+struct SynthSpec {
+    std::string Name;
+    uint16_t    Width;
+    uint16_t    Height;
+    size_t      Frames;
+    uint16_t    Colors;         // Palette size, a power of two from 2 to 256
+    uint8_t     MinCodeSize;    // LZW Minimum Code Size, 0 picks the smallest one that fits the palette
+    bool        Interlaced;
+    bool        LocalTables;    // Every frame gets a color table of its own
+    Pattern     Fill;
+    uint32_t    Seed;
+};
+
+// Encodes a GIF89a file in memory from a spec, with a real LZW dictionary so code
+// widths grow and the table gets cleared the way they do in files from other encoders
+class SynthGif
+{
+    public:
+        SynthGif(const SynthSpec& _spec);
+
+        const SynthSpec& Spec() const { return this->mSpec; }
+
+        // Whole file
+        const uint8_t* Data() const { return this->mData.data(); }
+        size_t Size() const { return this->mData.size(); }
+
+        size_t FrameCount() const { return this->mCodestreams.size(); }
+        uint8_t MinCodeSize() const { return this->mMinCodeSize; }
+
+        // Code stream of a frame with the sub block framing removed, as LZW::Decompress takes it
+        const std::vector<uint8_t>& Codestream(size_t index) const { return this->mCodestreams[index]; }
+
+        // Number of color indices a frame decodes into
+        size_t FramePixels(size_t index) const { return this->mFramePixels[index]; }
+
+        /**
+         * Write the file out to look at it with other tools
+         *
+         * @param path - File to create
+         * @return true if the whole file was written
+         */
+        bool Save(const char* path) const;
+
+    private:
+        SynthSpec mSpec;
+        uint8_t mMinCodeSize;
+        uint32_t mRandom;
+
+        std::vector<uint8_t> mData;
+        std::vector<std::vector<uint8_t>> mCodestreams;
+        std::vector<size_t> mFramePixels;
+
+    private:
+        uint32_t Next();
+        void WritePalette(uint16_t colors);
+        void WriteFrame(size_t frame);
+        void Put16(uint16_t value);
+};
+
+namespace LZW
+{
+    /**
+     * Compress color indices into a GIF code stream (without sub block framing).
+     * Codes start at minCodeSize + 1 bits and grow to 12, once the table is full a clear code is sent
+     *
+     * @param minCodeSize - LZW Minimum Code Size, every index must be below 1 << minCodeSize
+     * @param indices - Color indices to compress
+     * @param count - Number of indices
+     * @param codestream - Receives the compressed bytes
+     * @return NONE
+     */
+    void Compress(const uint8_t minCodeSize, const uint8_t* indices, const size_t count, std::vector<uint8_t>* codestream);
+}
+
+#endif // _SYNTHGIF_HPP
@@ -0,0 +1,271 @@
+#include "synthgif.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+// Size of the open addressed table the encoder looks strings up in, twice the number of codes
+#define LZW_HASH_SIZE       8192
+#define LZW_ENCODE_CODES    4096
+
+// Side of the block the sprite pattern moves around
+#define SPRITE_SIZE         32
+
+// Rows of every interlace pass, starting row and distance between rows
+static const uint8_t INTERLACE_START[4] = {0, 4, 2, 1};
+static const uint8_t INTERLACE_STEP[4] = {8, 8, 4, 2};
+
+namespace LZW
+{
+    // Packs codes into bytes, least significant bit first as GIF stores them
+    class BitWriter
+    {
+        public:
+            BitWriter(std::vector<uint8_t>* _output)
+            {
+                this->mOutput = _output;
+                this->mBuffer = 0;
+                this->mCount = 0;
+            }
+
+            void Write(uint16_t code, uint8_t size)
+            {
+                this->mBuffer |= (uint32_t)code << this->mCount;
+                this->mCount += size;
+
+                while (this->mCount >= 8) {
+                    this->mOutput->push_back(this->mBuffer & 0xFF);
+                    this->mBuffer >>= 8;
+                    this->mCount -= 8;
+                }
+            }
+
+            void Flush()
+            {
+                if (this->mCount > 0)
+                    this->mOutput->push_back(this->mBuffer & 0xFF);
+
+                this->mBuffer = 0;
+                this->mCount = 0;
+            }
+
+        private:
+            std::vector<uint8_t>* mOutput;
+            uint32_t mBuffer;
+            uint8_t mCount;
+    };
+
+    void Compress(const uint8_t minCodeSize, const uint8_t* indices, const size_t count, std::vector<uint8_t>* codestream)
+    {
+        codestream->clear();
+
+        const uint16_t clearCode = 1 << minCodeSize;
+        const uint16_t endCode = clearCode + 1;
+
+        // Strings are looked up by (prefix code, next index), an empty slot holds 0xFFFFFFFF
+        std::vector<uint32_t> keys(LZW_HASH_SIZE);
+        std::vector<uint16_t> codes(LZW_HASH_SIZE);
+
+        BitWriter writer(codestream);
+        uint16_t nextCode = 0;
+        uint8_t codeSize = 0;
+
+        auto reset = [&]() {
+            memset(keys.data(), 0xFF, keys.size() * sizeof(uint32_t));
+            nextCode = endCode + 1;
+            codeSize = minCodeSize + 1;
+        };
+
+        writer.Write(clearCode, minCodeSize + 1);
+        reset();
+
+        if (count == 0) {
+            writer.Write(endCode, codeSize);
+            writer.Flush();
+            return;
+        }
+
+        uint16_t prefix = indices[0];
+        for (size_t i = 1; i < count; i++) {
+            uint32_t key = ((uint32_t)prefix << 8) | indices[i];
+            uint32_t slot = (key * 2654435761u) >> 19;
+
+            while (keys[slot] != 0xFFFFFFFF && keys[slot] != key)
+                slot = (slot + 1) & (LZW_HASH_SIZE - 1);
+
+            if (keys[slot] == key) {
+                prefix = codes[slot];
+                continue;
+            }
+
+            writer.Write(prefix, codeSize);
+
+            // The decoder adds every entry one code after the encoder does,
+            // so codes only widen once the entry past the current width exists
+            keys[slot] = key;
+            codes[slot] = nextCode++;
+
+            if (nextCode - 1 > (1 << codeSize) - 1 && codeSize < 12)
+                codeSize++;
+
+            if (nextCode == LZW_ENCODE_CODES) {
+                writer.Write(clearCode, codeSize);
+                reset();
+            }
+
+            prefix = indices[i];
+        }
+
+        writer.Write(prefix, codeSize);
+        writer.Write(endCode, codeSize);
+        writer.Flush();
+    }
+}
+
+SynthGif::SynthGif(const SynthSpec& _spec)
+{
+    this->mSpec = _spec;
+    this->mRandom = _spec.Seed ? _spec.Seed : 1;
+
+    uint8_t bits = 1;
+    while ((1 << bits) < this->mSpec.Colors)
+        bits++;
+
+    this->mSpec.Colors = 1 << bits;
+    this->mMinCodeSize = (bits < 2) ? 2 : bits;
+    if (this->mSpec.MinCodeSize > this->mMinCodeSize && this->mSpec.MinCodeSize <= 8)
+        this->mMinCodeSize = this->mSpec.MinCodeSize;
+
+    // Header and Logical Screen Descriptor with a global color table
+    const char* header = "GIF89a";
+    this->mData.insert(this->mData.end(), header, header + 6);
+    Put16(this->mSpec.Width);
+    Put16(this->mSpec.Height);
+    this->mData.push_back(0x80 | 0x70 | (bits - 1));
+    this->mData.push_back(0);
+    this->mData.push_back(0);
+    WritePalette(this->mSpec.Colors);
+
+    // Loop forever (NETSCAPE2.0 application extension)
+    const uint8_t loop[19] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+    this->mData.insert(this->mData.end(), loop, loop + sizeof(loop));
+
+    for (size_t i = 0; i < this->mSpec.Frames; i++)
+        WriteFrame(i);
+
+    this->mData.push_back(0x3B);
+}
+
+uint32_t SynthGif::Next()
+{
+    // xorshift32, the same spec always gives the same file
+    this->mRandom ^= this->mRandom << 13;
+    this->mRandom ^= this->mRandom >> 17;
+    this->mRandom ^= this->mRandom << 5;
+    return this->mRandom;
+}
+
+void SynthGif::Put16(uint16_t value)
+{
+    this->mData.push_back(value & 0xFF);
+    this->mData.push_back(value >> 8);
+}
+
+void SynthGif::WritePalette(uint16_t colors)
+{
+    for (uint16_t i = 0; i < colors * 3; i++)
+        this->mData.push_back(Next() & 0xFF);
+}
+
+void SynthGif::WriteFrame(size_t frame)
+{
+    const SynthSpec& spec = this->mSpec;
+    uint16_t left = 0;
+    uint16_t top = 0;
+    uint16_t width = spec.Width;
+    uint16_t height = spec.Height;
+
+    // After the background the sprite pattern only redraws the block that moved
+    if (spec.Fill == Pattern::Sprite && frame > 0) {
+        width = (spec.Width < SPRITE_SIZE) ? spec.Width : SPRITE_SIZE;
+        height = (spec.Height < SPRITE_SIZE) ? spec.Height : SPRITE_SIZE;
+        left = (frame * 7) % (spec.Width - width + 1);
+        top = (frame * 5) % (spec.Height - height + 1);
+    }
+
+    std::vector<uint8_t> pixels((size_t)width * height);
+    uint16_t mask = spec.Colors - 1;
+    for (uint16_t y = 0; y < height; y++) {
+        for (uint16_t x = 0; x < width; x++) {
+            uint8_t index = 0;
+            switch (spec.Fill) {
+            case Pattern::Noise:
+                index = Next() & mask;
+                break;
+            case Pattern::Gradient:
+                index = ((x + 2 * y + frame * 3) / 4) & mask;
+                break;
+            case Pattern::Sprite:
+                index = (frame == 0) ? ((x / 8 + y / 8) & mask) : ((x ^ y ^ frame) & mask);
+                break;
+            }
+
+            pixels[(size_t)y * width + x] = index;
+        }
+    }
+
+    // Interlaced frames store their rows pass by pass
+    if (spec.Interlaced) {
+        std::vector<uint8_t> ordered(pixels.size());
+        size_t row = 0;
+        for (int pass = 0; pass < 4; pass++) {
+            for (uint16_t y = INTERLACE_START[pass]; y < height; y += INTERLACE_STEP[pass])
+                memcpy(&ordered[(row++) * width], &pixels[(size_t)y * width], width);
+        }
+
+        pixels.swap(ordered);
+    }
+
+    // Graphic Control Extension, 40ms delay and frames stay on screen
+    const uint8_t control[8] = {0x21, 0xF9, 0x04, 0x01 << 2, 4, 0, 0, 0};
+    this->mData.insert(this->mData.end(), control, control + sizeof(control));
+
+    // Image Descriptor
+    uint8_t bits = 1;
+    while ((1 << bits) < spec.Colors)
+        bits++;
+
+    this->mData.push_back(0x2C);
+    Put16(left);
+    Put16(top);
+    Put16(width);
+    Put16(height);
+    this->mData.push_back((spec.LocalTables ? (0x80 | (bits - 1)) : 0) | (spec.Interlaced ? 0x40 : 0));
+    if (spec.LocalTables)
+        WritePalette(spec.Colors);
+
+    std::vector<uint8_t> codestream;
+    LZW::Compress(this->mMinCodeSize, pixels.data(), pixels.size(), &codestream);
+
+    // Image data, the code stream split into sub blocks of at most 255 bytes
+    this->mData.push_back(this->mMinCodeSize);
+    for (size_t offset = 0; offset < codestream.size(); offset += 255) {
+        size_t size = (codestream.size() - offset < 255) ? codestream.size() - offset : 255;
+        this->mData.push_back((uint8_t)size);
+        this->mData.insert(this->mData.end(), codestream.begin() + offset, codestream.begin() + offset + size);
+    }
+    this->mData.push_back(0);
+
+    this->mCodestreams.push_back(std::move(codestream));
+    this->mFramePixels.push_back(pixels.size());
+}
+
+bool SynthGif::Save(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    size_t written = fwrite(this->mData.data(), 1, this->mData.size(), file);
+    fclose(file);
+    return written == this->mData.size();
+}
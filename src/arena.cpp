@@ -0,0 +1,72 @@
+#include "arena.hpp"
+
+// Keeps every allocation aligned well enough for any type
+#define ARENA_ALIGNMENT 16
+
+DecodeArena::DecodeArena()
+{
+    this->mBlock = 0;
+    this->mUsed = 0;
+    this->mStats = {};
+    this->mFrameStartAllocations = 0;
+}
+
+uint8_t* DecodeArena::Allocate(size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    // Move on through the blocks kept from earlier frames before making a new one
+    while (this->mBlock < this->mBlocks.size() && this->mUsed + size > this->mBlocks[this->mBlock].Size) {
+        this->mBlock++;
+        this->mUsed = 0;
+    }
+
+    if (this->mBlock == this->mBlocks.size())
+        AddBlock((size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE);
+
+    uint8_t* memory = this->mBlocks[this->mBlock].Data.get() + this->mUsed;
+    this->mUsed += size;
+    return memory;
+}
+
+Canvas& DecodeArena::Raster(uint16_t width, uint16_t height)
+{
+    return Reuse(this->mRaster, width, height);
+}
+
+Canvas& DecodeArena::Preview(uint16_t width, uint16_t height)
+{
+    return Reuse(this->mPreview, width, height);
+}
+
+Canvas& DecodeArena::Reuse(Canvas& canvas, uint16_t width, uint16_t height)
+{
+    size_t capacity = canvas.Capacity();
+    canvas.Resize(width, height, 0, width);
+
+    if (canvas.Capacity() != capacity) {
+        this->mStats.Allocations++;
+        this->mStats.Bytes += canvas.Capacity() - capacity;
+    }
+
+    return canvas;
+}
+
+void DecodeArena::Reset()
+{
+    this->mStats.LastFrameAllocations = this->mStats.Allocations - this->mFrameStartAllocations;
+    this->mFrameStartAllocations = this->mStats.Allocations;
+    this->mStats.Frames++;
+
+    this->mBlock = 0;
+    this->mUsed = 0;
+}
+
+void DecodeArena::AddBlock(size_t size)
+{
+    this->mBlocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    this->mUsed = 0;
+
+    this->mStats.Allocations++;
+    this->mStats.Bytes += size;
+}
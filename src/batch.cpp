@@ -0,0 +1,208 @@
+#include "batch.hpp"
+#include "gif.hpp"
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+#include "utils/threadpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <future>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+BatchConverter::BatchConverter(const std::string& _outputDir, unsigned int _threads, RenderMode _mode, CellMode _cells)
+{
+    this->mOutputDir = _outputDir;
+    this->mThreads = (_threads == 0) ? 1 : _threads;
+    this->mMode = _mode;
+    this->mCells = _cells;
+}
+
+void BatchConverter::Add(const std::string& path)
+{
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        this->mInputs.push_back(path);
+        return;
+    }
+
+    // Directory entries come back in no particular order, sort them so runs are repeatable
+    std::vector<std::string> files;
+    for (const fs::directory_entry& entry : fs::directory_iterator(path, ec)) {
+        std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file(ec) && (extension == ".gif" || extension == ".GIF"))
+            files.push_back(entry.path().string());
+    }
+
+    std::sort(files.begin(), files.end());
+    this->mInputs.insert(this->mInputs.end(), files.begin(), files.end());
+}
+
+size_t BatchConverter::Run()
+{
+    std::error_code ec;
+    fs::create_directories(this->mOutputDir, ec);
+
+    logger.Log(DEBUG, "Converting %d files on %d threads", (int)this->mInputs.size(), this->mThreads);
+    auto start = std::chrono::steady_clock::now();
+
+    // Every file is independent so each one is a single task, the GIFs themselves decode serially.
+    // Output names are picked up front, in input order, so runs name their files the same way
+    std::vector<std::future<BatchResult>> pending;
+    {
+        ThreadPool pool(this->mThreads);
+        std::unordered_set<std::string> taken;
+        for (const std::string& input : this->mInputs) {
+            std::string output = OutputPath(input, &taken);
+            pending.push_back(pool.Submit([this, input, output] { return Convert(input, output); }));
+        }
+
+        this->mResults.clear();
+        for (std::future<BatchResult>& result : pending) {
+            this->mResults.push_back(result.get());
+            PrintResult(this->mResults.back());
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    PrintSummary(seconds);
+
+    size_t failed = 0;
+    for (const BatchResult& result : this->mResults) {
+        if (!result.Success)
+            failed++;
+    }
+
+    return failed;
+}
+
+BatchResult BatchConverter::Convert(const std::string& input, const std::string& output) const
+{
+    BatchResult result = {};
+    result.Input = input;
+    result.Output = output;
+
+    std::error_code ec;
+    result.BytesIn = fs::file_size(input, ec);
+    if (ec) {
+        logger.Log(WARNING, "Batch: Could not read [%s]", input.c_str());
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    int fd = open(result.Output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        logger.Log(WARNING, "Batch: Could not create [%s]: %s", result.Output.c_str(), strerror(errno));
+        return result;
+    }
+
+    // A broken file only fails its own conversion, the rest of the batch carries on
+    try {
+        // Frames are decoded in order as they are written, reading only indexes them
+        // so their sizes can be checked before anything is allocated for them
+        GIF gif = GIF(input.c_str());
+        gif.SetLazy(1, SIZE_MAX);
+        gif.Read();
+
+        if ((size_t)gif.mLsd.Width * gif.mLsd.Height > BATCH_MAX_PIXELS)
+            error(Severity::medium, "Batch:", "Screen of", gif.mLsd.Width, "x", gif.mLsd.Height, "is too large");
+
+        for (size_t frameIdx = 0; frameIdx < gif.FrameCount(); frameIdx++) {
+            const FrameInfo& info = gif.Index()[frameIdx];
+            if ((size_t)info.Width * info.Height > BATCH_MAX_PIXELS)
+                error(Severity::medium, "Batch:", "Frame", frameIdx, "of", info.Width, "x", info.Height, "is too large");
+        }
+
+        // Replaying the file (cat) draws every frame over the last one like the display does
+        Renderer renderer = Renderer(gif.mLsd.Width, gif.mLsd.Height, this->mMode, this->mCells);
+        renderer.Clear(fd);
+        result.Success = true;
+
+        for (size_t frameIdx = 0; frameIdx < gif.FrameCount() && result.Success; frameIdx++) {
+            renderer.Render(gif.GetFrame(frameIdx));
+            result.Success = renderer.Flush(fd);
+            result.BytesOut += renderer.Size();
+            result.Frames++;
+        }
+
+        std::string restore = std::string(ESC_RESET) + ESC_SHOW_CURSOR;
+        result.Success = result.Success && Renderer::WriteAll(fd, restore.data(), restore.size());
+
+        if (!result.Success)
+            logger.Log(WARNING, "Batch: Could not write [%s]", result.Output.c_str());
+    } catch (const std::exception& e) {
+        // Anything a file can make the decoder throw (std::bad_alloc included) stays with that file
+        logger.Log(WARNING, "Batch: Could not convert [%s]: %s", input.c_str(), e.what());
+        result.Success = false;
+    }
+
+    close(fd);
+
+    // A failed conversion leaves no partial file behind
+    if (!result.Success)
+        unlink(result.Output.c_str());
+
+    result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::string BatchConverter::OutputPath(const std::string& input, std::unordered_set<std::string>* taken) const
+{
+    fs::path output = fs::path(this->mOutputDir) / fs::path(input).filename();
+    output.replace_extension(BATCH_OUTPUT_EXTENSION);
+
+    // The second x.gif becomes x-1.ans, the third x-2.ans and so on
+    std::string stem = output.stem().string();
+    for (unsigned int suffix = 1; taken->count(output.string()) > 0; suffix++)
+        output.replace_filename(stem + "-" + std::to_string(suffix) + BATCH_OUTPUT_EXTENSION);
+
+    taken->insert(output.string());
+    return output.string();
+}
+
+void BatchConverter::PrintResult(const BatchResult& result)
+{
+    if (!result.Success) {
+        fprintf(stdout, "FAILED %s\n", result.Input.c_str());
+        return;
+    }
+
+    double seconds = (result.Seconds > 0) ? result.Seconds : 1e-9;
+    fprintf(stdout, "%s -> %s: %zu frames, %zukB in, %zukB out, %.1fms (%.1f frames/s, %.2f MB/s)\n",
+            result.Input.c_str(), result.Output.c_str(), result.Frames,
+            result.BytesIn / 1024, result.BytesOut / 1024, result.Seconds * 1000,
+            result.Frames / seconds, result.BytesIn / seconds / (1024 * 1024));
+}
+
+void BatchConverter::PrintSummary(double seconds)
+{
+    size_t converted = 0;
+    size_t frames = 0;
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+    for (const BatchResult& result : this->mResults) {
+        if (!result.Success)
+            continue;
+
+        converted++;
+        frames += result.Frames;
+        bytesIn += result.BytesIn;
+        bytesOut += result.BytesOut;
+    }
+
+    if (seconds <= 0)
+        seconds = 1e-9;
+
+    fprintf(stdout, "Converted %zu/%zu files on %u threads: %zu frames, %zukB in, %zukB out in %.1fms\n",
+            converted, this->mResults.size(), this->mThreads, frames, bytesIn / 1024, bytesOut / 1024, seconds * 1000);
+    fprintf(stdout, "Throughput: %.1f files/s, %.1f frames/s, %.2f MB/s\n",
+            converted / seconds, frames / seconds, bytesIn / seconds / (1024 * 1024));
+}
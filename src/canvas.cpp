@@ -0,0 +1,154 @@
+#include "canvas.hpp"
+
+#include <string.h>
+
+Canvas::Canvas()
+{
+    this->mWidth = 0;
+    this->mHeight = 0;
+    this->mStride = 0;
+    this->mPixelSize = 1;
+}
+
+Canvas::Canvas(uint16_t _width, uint16_t _height, uint8_t _fill, size_t _stride)
+{
+    Resize(_width, _height, _fill, _stride);
+}
+
+void Canvas::Allocate(uint16_t width, uint16_t height, uint8_t pixelSize, size_t stride)
+{
+    size_t rowSize = (size_t)width * pixelSize;
+    if (stride < rowSize)
+        stride = (rowSize + CANVAS_ROW_ALIGNMENT - 1) & ~(size_t)(CANVAS_ROW_ALIGNMENT - 1);
+
+    this->mWidth = width;
+    this->mHeight = height;
+    this->mStride = stride;
+    this->mPixelSize = pixelSize;
+}
+
+void Canvas::Resize(uint16_t width, uint16_t height, uint8_t fill, size_t stride)
+{
+    Allocate(width, height, 1, stride);
+    this->mPixels.assign(this->mStride * height, fill);
+}
+
+void Canvas::Fill(uint8_t index)
+{
+    memset(this->mPixels.data(), index, this->mPixels.size());
+}
+
+void Canvas::ResizeRGB(uint16_t width, uint16_t height, const Color& fill)
+{
+    Allocate(width, height, COLOR_SIZE, 0);
+    this->mPixels.resize(this->mStride * height);
+    FillRect({0, 0, width, height}, fill);
+}
+
+void Canvas::FillRect(const Rect& rect, const Color& color)
+{
+    for (uint16_t row = rect.Top; row < rect.Top + rect.Height; row++) {
+        uint8_t* pixel = Row(row) + (rect.Left * COLOR_SIZE);
+        for (uint16_t col = 0; col < rect.Width; col++) {
+            pixel[0] = color.Red;
+            pixel[1] = color.Green;
+            pixel[2] = color.Blue;
+            pixel += COLOR_SIZE;
+        }
+    }
+}
+
+void Canvas::Blit(const Canvas& source, uint16_t left, uint16_t top)
+{
+    if (left >= this->mWidth || top >= this->mHeight)
+        return;
+
+    size_t width = source.mWidth;
+    if (left + width > this->mWidth)
+        width = this->mWidth - left;
+
+    uint16_t height = source.mHeight;
+    if (top + height > this->mHeight)
+        height = this->mHeight - top;
+
+    for (uint16_t row = 0; row < height; row++)
+        memcpy(Row(top + row) + (left * this->mPixelSize), source.Row(row), width * this->mPixelSize);
+}
+
+Rect Canvas::Diff(const Canvas& other) const
+{
+    Rect rect = {};
+    if (this->mWidth != other.mWidth || this->mHeight != other.mHeight || this->mPixelSize != other.mPixelSize)
+        return {0, 0, this->mWidth, this->mHeight};
+
+    // Rows are compared byte by byte, the bytes found are turned back into pixels at the end
+    int rowSize = this->mWidth * this->mPixelSize;
+    int top = -1;
+    int bottom = -1;
+    int left = rowSize;
+    int right = -1;
+    for (uint16_t row = 0; row < this->mHeight; row++) {
+        const uint8_t* a = Row(row);
+        const uint8_t* b = other.Row(row);
+
+        // Most rows of an animation are unchanged and memcmp rules them out quickly
+        if (memcmp(a, b, rowSize) == 0)
+            continue;
+
+        if (top < 0)
+            top = row;
+        bottom = row;
+
+        int first = 0;
+        while (a[first] == b[first])
+            first++;
+
+        int last = rowSize - 1;
+        while (a[last] == b[last])
+            last--;
+
+        if (first < left)
+            left = first;
+        if (last > right)
+            right = last;
+    }
+
+    if (top < 0)
+        return rect;
+
+    rect.Left = left / this->mPixelSize;
+    rect.Top = top;
+    rect.Width = (right / this->mPixelSize) - rect.Left + 1;
+    rect.Height = bottom - top + 1;
+    return rect;
+}
+
+void Canvas::CopyRect(const Canvas& source, const Rect& rect)
+{
+    size_t offset = (size_t)rect.Left * this->mPixelSize;
+    for (uint16_t row = rect.Top; row < rect.Top + rect.Height; row++)
+        memcpy(Row(row) + offset, source.Row(row) + offset, (size_t)rect.Width * this->mPixelSize);
+}
+
+void Canvas::Crop(const Canvas& source, const Rect& rect)
+{
+    size_t rowSize = (size_t)rect.Width * source.mPixelSize;
+    Allocate(rect.Width, rect.Height, source.mPixelSize, rowSize);
+    this->mPixels.resize(rowSize * rect.Height);
+
+    for (uint16_t row = 0; row < rect.Height; row++)
+        memcpy(Row(row), source.Row(rect.Top + row) + (rect.Left * source.mPixelSize), rowSize);
+}
+
+bool Canvas::operator==(const Canvas& other) const
+{
+    if (this->mWidth != other.mWidth || this->mHeight != other.mHeight || this->mPixelSize != other.mPixelSize)
+        return false;
+
+    for (uint16_t row = 0; row < this->mHeight; row++) {
+        if (memcmp(Row(row), other.Row(row), (size_t)this->mWidth * this->mPixelSize) != 0)
+            return false;
+    }
+
+    return true;
+}
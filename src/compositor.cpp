@@ -0,0 +1,121 @@
+#include "compositor.hpp"
+#include "kernels.hpp"
+#include "utils/logger.hpp"
+
+Compositor::Compositor()
+{
+    this->mBackground = NULL_COLOR;
+    this->mDisposal = Disposal::None;
+    this->mArea = {};
+}
+
+void Compositor::Reset(uint16_t width, uint16_t height, const Color& background)
+{
+    // The screen starts out as the background color, not a blank character
+    this->mBackground = background;
+    this->mScreen.ResizeRGB(width, height, background);
+    this->mDisposal = Disposal::None;
+    this->mArea = {};
+}
+
+void Compositor::Restart(const Canvas& base)
+{
+    this->mScreen = base;
+    this->mDisposal = Disposal::None;
+    this->mArea = {};
+}
+
+void Compositor::Draw(const FrameInfo& info, const Canvas& raster)
+{
+    Dispose(&this->mScreen);
+
+    this->mArea = Clip(info);
+    this->mDisposal = (Disposal)info.Disposal;
+
+    // Unknown (reserved) disposal methods are treated like the unspecified one
+    if (info.Disposal > (uint8_t)Disposal::Previous) {
+        logger.Log(DEBUG, "Compositor: Undefined disposal method %d, leaving the frame in place", info.Disposal);
+        this->mDisposal = Disposal::None;
+    }
+
+    // Only the area the frame covers can change, so only that much has to be put back later
+    if (this->mDisposal == Disposal::Previous)
+        this->mSaved.Crop(this->mScreen, this->mArea);
+
+    DrawRaster(&this->mScreen, this->mArea, info, raster);
+}
+
+void Compositor::Base(Canvas* base) const
+{
+    *base = this->mScreen;
+    Dispose(base);
+}
+
+void Compositor::Preview(const FrameInfo& info, const Canvas& raster, Canvas* preview) const
+{
+    Base(preview);
+    DrawRaster(preview, Clip(info), info, raster);
+}
+
+Rect Compositor::Clip(const FrameInfo& info) const
+{
+    Rect area = {info.Left, info.Top, 0, 0};
+    if (info.Left >= this->mScreen.Width() || info.Top >= this->mScreen.Height())
+        return area;
+
+    area.Width = (info.Width < this->mScreen.Width() - info.Left) ? info.Width : this->mScreen.Width() - info.Left;
+    area.Height = (info.Height < this->mScreen.Height() - info.Top) ? info.Height : this->mScreen.Height() - info.Top;
+    return area;
+}
+
+void Compositor::Dispose(Canvas* screen) const
+{
+    if (this->mArea.Empty())
+        return;
+
+    switch (this->mDisposal) {
+    case Disposal::Background:
+        screen->FillRect(this->mArea, this->mBackground);
+        break;
+    case Disposal::Previous:
+        screen->Blit(this->mSaved, this->mArea.Left, this->mArea.Top);
+        break;
+    case Disposal::None:
+    case Disposal::DoNotDispose:
+        break;
+    }
+}
+
+void Compositor::DrawRaster(Canvas* screen, const Rect& area, const FrameInfo& info, const Canvas& raster)
+{
+    // A truncated raster is drawn as far as it goes
+    uint16_t width = (area.Width < raster.Width()) ? area.Width : raster.Width();
+    uint16_t height = (area.Height < raster.Height()) ? area.Height : raster.Height();
+
+    // Indices are only valid for the frame's own table, so they are turned into colors right here
+    uint32_t palette[256];
+    Kernels::PackPalette(info.ColorTable, info.ColorCount, palette);
+
+    for (uint16_t row = 0; row < height; row++) {
+        const uint8_t* source = raster.Row(row);
+        uint8_t* target = screen->Row(area.Top + row) + (area.Left * COLOR_SIZE);
+
+        // Rows of an opaque frame are expanded whole
+        if (!info.Transparent) {
+            Kernels::ExpandRGB(source, width, palette, target);
+            continue;
+        }
+
+        uint8_t transparent = info.TransparentColorIndex;
+        for (uint16_t col = 0; col < width; col++) {
+            if (source[col] != transparent) {
+                uint32_t color = palette[source[col]];
+                target[0] = color & 0xFF;
+                target[1] = (color >> 8) & 0xFF;
+                target[2] = (color >> 16) & 0xFF;
+            }
+
+            target += COLOR_SIZE;
+        }
+    }
+}
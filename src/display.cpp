@@ -1,20 +1,51 @@
 #include "display.hpp"
+#include "kernels.hpp"
+#include "player.hpp"
 #include "utils/logger.hpp"
-#include "lzw.hpp"
+#include "utils/terminal.hpp"
 
+#include <memory>
+#include <stdint.h>
 #include <signal.h>
-#include <unordered_map>
 #include <string.h>
 #include <tgmath.h>
-#include <thread>
-#include <chrono>
+#include <unistd.h>
 
-constexpr const char* CHAR_MAP = "$@B%8&WM#*oahkbdpqwmZO0QLCJUYXzcvunxrjft/\\|()1{}[]?-_+~i!lI;:,\"^`\'.";
+Scaler FitToTerminal(GIF* gif, float cellAspect, CellMode cells)
+{
+    uint16_t columns = 0;
+    uint16_t rows = 0;
+
+    // Full frames end every row with a line break, one row is left free so the last one does not scroll the screen
+    if (TerminalSize(STDOUT_FILENO, &columns, &rows) && rows > 1)
+        rows--;
+
+    return FitToCells(gif, columns, rows, cellAspect, cells);
+}
 
-GifDisplay::GifDisplay(const GIF* _gif)
+Scaler FitToCells(GIF* gif, uint16_t columns, uint16_t rows, float cellAspect, CellMode cells)
+{
+    // Half blocks stack two pixels in every cell, each of them is half as tall as a cell
+    if (cells == CellMode::HalfBlock) {
+        rows *= 2;
+        cellAspect /= 2;
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    Scaler::Fit(gif->mLsd.Width, gif->mLsd.Height, columns, rows, cellAspect, &width, &height);
+
+    return Scaler(gif->mLsd.Width, gif->mLsd.Height, width, height);
+}
+
+GifDisplay::GifDisplay(GIF* _gif, RenderMode _mode, float _cellAspect, CellMode _cells)
+    : mScaler(FitToTerminal(_gif, _cellAspect, _cells)),
+      mRenderer(mScaler.Width(), mScaler.Height(), _mode, _cells)
 {
     this->mGIF = _gif;
-    this->mCharMap = "$@B%8&WM#*oahkbdpqwmZO0QLCJUYXzcvunxrjft/\\|()1{}[]?-_+~i!lI;:,\"^`\'.";
+    this->mCharMap = CHAR_MAP;
+    this->mDecodeAhead = 0;
+    this->mProgressive = false;
 }
 
 GifDisplay::~GifDisplay() {}
@@ -22,61 +53,137 @@ GifDisplay::~GifDisplay() {}
 void GifDisplay::LoopFrames()
 {
     /* TODO
-     * Because of the system("clear") calls, all of the gif meta is
+     * Because the screen is cleared before drawing, all of the gif meta is
      * destroyed, if I want to see the gif meta I should try to write
      * it into a seperate file before drawing
      */
 
     signal(SIGINT, this->mGIF->SigIntHandler);
-    std::unordered_map<int, std::string> codeTable = LZW::InitializeCodeTable(this->mGIF->mGctd.NumberOfColors);
-    
-    system("clear");
+
+    // Frames come from a decoder thread instead of being decoded between two frames
+    std::unique_ptr<FramePlayer> player;
+    if (this->mDecodeAhead > 0) {
+        player.reset(new FramePlayer(this->mGIF, this->mDecodeAhead));
+        player->Start();
+
+        // Playback starts as soon as the first frame is ready
+        player->Next();
+    }
+
+    size_t frameCount = this->mGIF->FrameCount();
+
+    // Frame on screen, and whether the renderer missed frames that were replayed from the cache
+    size_t lastShown = SIZE_MAX;
+    bool rendererBehind = false;
+    bool replaying = false;
+
+    // Previews are drawn while GetFrame() decodes, the output that follows them only redraws what the
+    // preview got wrong so it can not be cached as the step from the frame before
+    bool previewed = false;
+    if (this->mProgressive && !player) {
+        this->mGIF->SetProgressive([this, &previewed](size_t index, const Canvas& screen) {
+            DrawFrame(screen);
+            previewed = true;
+        });
+    }
+
+    // Clear the screen once, every frame after that is drawn over the last one from the top left
+    this->mRenderer.Clear(STDOUT_FILENO);
+    this->mScheduler.Start();
     while (true) {
-        int frameIdx = 0;
-        for (std::vector<char> frame : this->mGIF->mFrameMap) {
-            int col = 0;
-            for (char c : frame) {
-                // If for some reason a the character in the map is below zero, break
-                if (c < 0)
-                    break;
-
-                if (c == codeTable.at((int)codeTable.size() - 1)[0]) {
-                    logger.Log(DEBUG, " - End of information");
-                    break; 
+        for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++) {
+            const FrameInfo& info = this->mGIF->Index()[frameIdx];
+
+            // The decoder works through the frames in order, a dropped frame still has to be taken out of the ring
+            const Canvas* frame = (player) ? &player->Next().Pixels : nullptr;
+
+            // Frames drawn too late to be seen are skipped so playback keeps real time
+            bool show = this->mScheduler.Begin(info.DelayTime * 10);
+            if (show) {
+                // Cached output can only be replayed (or stored) over the frame right before it
+                bool follows = (lastShown == (frameIdx + frameCount - 1) % frameCount);
+                const std::vector<char>* cached = follows ? this->mCache.Find(frameIdx) : nullptr;
+
+                if (cached != nullptr) {
+                    Renderer::WriteAll(STDOUT_FILENO, cached->data(), cached->size());
+                    rendererBehind = true;
+                } else {
+                    // The renderer did not see the replayed frames, it has to start over with a full frame
+                    if (rendererBehind) {
+                        this->mRenderer.Invalidate();
+                        rendererBehind = false;
+                    }
+
+                    previewed = false;
+                    if (frame == nullptr)
+                        frame = &this->mGIF->GetFrame(frameIdx);
+
+                    DrawFrame(*frame);
+
+                    // A cache that is too small turns itself off, say so instead of quietly rendering every loop
+                    if (follows && !previewed && this->mCache.Enabled()
+                        && !this->mCache.Insert(frameIdx, this->mRenderer.Data(), this->mRenderer.Size()))
+                        logger.Log(WARNING, "Render cache is too small for every frame, frames are rendered live");
                 }
-                
-                Color color = this->mGIF->mColorTable[(int)c];
-                if (this->mGIF->mImageData[frameIdx].mTransparent 
-                && c == this->mGIF->mImageData[frameIdx].mTransparentColorIndex) {
-                    // Add transparent color  
-                    color = this->mGIF->mColorTable[this->mGIF->mImageData[frameIdx].mTransparentColorIndex - 1];
-                } 
-                
-                fprintf(stdout, "\x1b[38;2;%d;%d;%dm", color.Red, color.Blue, color.Green);
-                fprintf(stdout, "\x1b[48;2;%d;%d;%dm", color.Red, color.Blue, color.Green);
-                fprintf(stdout, "%c", color.ToChar());
-                fprintf(stdout, "\x1b[0m");
-                col++;
-
-                if (col >= this->mGIF->mLsd.Width) {
-                    col = 0;
-                    fprintf(stdout, "\n"); 
-                } 
-            } 
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(this->mGIF->mImageData[frameIdx].mExtensions.GraphicsControl.DelayTime * 10));
-            frameIdx++;
-            system("clear");
-        } 
+
+                lastShown = frameIdx;
+            }
+
+            // The slot can be refilled while this frame is on screen
+            if (player)
+                player->Release();
+
+            if (show)
+                this->mScheduler.Wait();
+        }
+
+        this->mScheduler.Report();
+
+        if (!replaying && this->mCache.Complete(frameCount)) {
+            logger.Log(INFO, "Render cache holds every frame (%zukB), replaying it from here on", this->mCache.Bytes() / 1024);
+            replaying = true;
+        }
+
+        // Every loop from here on is replayed, frames are only decoded again if one gets dropped
+        if (player && this->mCache.Complete(frameCount)) {
+            logger.Log(DEBUG, "Stopping the decoder");
+            player.reset();
+        }
+    }
+}
+
+void GifDisplay::DrawFrame(const Canvas& frame)
+{
+    // One pixel per cell needs no filtering, the screen is drawn as it is
+    if (this->mScaler.Enabled()) {
+        this->mScaler.Scale(frame);
+        this->mRenderer.Render(this->mScaler.RGB(), this->mScaler.Glyphs());
+    } else {
+        this->mRenderer.Render(frame);
     }
+
+    this->mRenderer.Flush(STDOUT_FILENO);
+}
+
+void GifDisplay::SetProgressive(bool enabled)
+{
+    this->mProgressive = enabled;
+}
+
+void GifDisplay::SetRenderCache(size_t bytes)
+{
+    this->mCache.SetCapacity(bytes);
+}
+
+void GifDisplay::SetDecodeAhead(size_t depth)
+{
+    this->mDecodeAhead = depth;
 }
 
-char Color::ToChar()
+char Color::ToChar() const
 {
-    // Brightness in this context is the brighness calculated in grayscale (https://en.wikipedia.org/wiki/Grayscale#Converting_color_to_grayscale)
-    float brightness = (0.2126 * Red + 0.7152 * Green * 0.0722 * Blue);
-    float chrIdx = brightness / (255.0 / strlen(CHAR_MAP));
-    return CHAR_MAP[(int)floor(chrIdx)]; 
+    // Same fixed point brightness the vectorized kernels use, so every path picks the same glyph
+    return CHAR_MAP[Kernels::LumaBucket(Red, Green, Blue, CHAR_MAP_SIZE)];
 }
 
 void Color::Print()
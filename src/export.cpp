@@ -0,0 +1,208 @@
+#include "export.hpp"
+#include "display.hpp"
+#include "utils/logger.hpp"
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+GifExporter::GifExporter(GIF* _gif, const ExportOptions& _options)
+    : mScaler(FitToCells(_gif, _options.Columns, _options.Rows, _options.CellAspect, _options.Cells)),
+      mRenderer(mScaler.Width(), mScaler.Height(), _options.Mode, _options.Cells),
+      mCache(_options.CacheBytes)
+{
+    this->mGIF = _gif;
+    this->mOptions = _options;
+    this->mBuffer.resize(EXPORT_BUFFER_SIZE);
+    this->mBuffered = 0;
+    this->mFd = -1;
+    this->mFailed = false;
+    this->mStats = {};
+
+    if (this->mOptions.Loops == 0)
+        this->mOptions.Loops = 1;
+}
+
+bool GifExporter::WriteStream(int fd)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    this->mFd = fd;
+    this->mFailed = false;
+
+    size_t frameCount = this->mGIF->FrameCount();
+
+    // Frame the stream ends on, and whether the renderer missed frames that were replayed from the cache
+    size_t lastShown = SIZE_MAX;
+    bool rendererBehind = false;
+    uint64_t timestamp = 0;
+
+    // Same start as the display, the screen is cleared once and every frame draws over the last one
+    std::string clear = std::string(ESC_HIDE_CURSOR) + ESC_CLEAR_SCREEN + ESC_CURSOR_HOME;
+    Append(clear.data(), clear.size());
+    this->mRenderer.Invalidate();
+
+    for (unsigned int loop = 0; loop < this->mOptions.Loops && !this->mFailed; loop++) {
+        for (size_t frameIdx = 0; frameIdx < frameCount && !this->mFailed; frameIdx++) {
+            const FrameInfo& info = this->mGIF->Index()[frameIdx];
+            uint32_t delay = info.DelayTime * 10;
+
+            if (this->mOptions.Timing) {
+                char marker[EXPORT_MARKER_MAX_SIZE];
+                int size = snprintf(marker, sizeof(marker), EXPORT_MARKER_FORMAT, loop, frameIdx, delay, (unsigned long long)timestamp);
+                Append(marker, size);
+            }
+
+            // Cached output can only be replayed (or stored) over the frame right before it
+            bool follows = (lastShown == (frameIdx + frameCount - 1) % frameCount);
+            const std::vector<char>* cached = follows ? this->mCache.Find(frameIdx) : nullptr;
+
+            if (cached != nullptr) {
+                Append(cached->data(), cached->size());
+                rendererBehind = true;
+            } else {
+                // The renderer did not see the replayed frames, it has to start over with a full frame
+                if (rendererBehind) {
+                    this->mRenderer.Invalidate();
+                    rendererBehind = false;
+                }
+
+                RenderFrame(this->mGIF->GetFrame(frameIdx));
+                Append(this->mRenderer.Data(), this->mRenderer.Size());
+
+                if (follows)
+                    this->mCache.Insert(frameIdx, this->mRenderer.Data(), this->mRenderer.Size());
+            }
+
+            lastShown = frameIdx;
+            timestamp += delay;
+            this->mStats.Frames++;
+        }
+    }
+
+    std::string restore = std::string(ESC_RESET) + ESC_SHOW_CURSOR;
+    Append(restore.data(), restore.size());
+    bool success = Flush();
+
+    if (!success)
+        logger.Log(WARNING, "Export: Could not write the stream: %s", strerror(errno));
+
+    this->mStats.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    logger.Log(INFO, "Exported %zu frames (%zukB) in %.1fms", this->mStats.Frames, this->mStats.Bytes / 1024, this->mStats.Seconds * 1000);
+
+    return success;
+}
+
+bool GifExporter::WriteFrames(const std::string& directory)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    std::string head = std::string(ESC_HIDE_CURSOR) + ESC_CLEAR_SCREEN;
+    std::string tail = std::string(ESC_RESET) + ESC_SHOW_CURSOR;
+    std::string timing;
+    uint64_t timestamp = 0;
+    bool success = true;
+
+    for (size_t frameIdx = 0; frameIdx < this->mGIF->FrameCount() && success; frameIdx++) {
+        const FrameInfo& info = this->mGIF->Index()[frameIdx];
+
+        char name[32];
+        snprintf(name, sizeof(name), EXPORT_FRAME_FORMAT, frameIdx);
+        std::string path = (fs::path(directory) / name).string();
+
+        this->mFd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (this->mFd < 0) {
+            logger.Log(WARNING, "Export: Could not create [%s]: %s", path.c_str(), strerror(errno));
+            success = false;
+            break;
+        }
+
+        // Every file stands on its own, so every frame is drawn in full
+        this->mFailed = false;
+        this->mRenderer.Invalidate();
+        RenderFrame(this->mGIF->GetFrame(frameIdx));
+
+        Append(head.data(), head.size());
+        Append(this->mRenderer.Data(), this->mRenderer.Size());
+        Append(tail.data(), tail.size());
+        success = Flush();
+        close(this->mFd);
+
+        if (!success)
+            logger.Log(WARNING, "Export: Could not write [%s]", path.c_str());
+
+        char line[64];
+        snprintf(line, sizeof(line), "%s %u %llu\n", name, info.DelayTime * 10, (unsigned long long)timestamp);
+        timing += line;
+        timestamp += info.DelayTime * 10;
+        this->mStats.Frames++;
+    }
+
+    // Frame file, delay and start time in milliseconds, one frame per line
+    std::string timingPath = (fs::path(directory) / EXPORT_TIMING_FILE).string();
+    int fd = open(timingPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || !Renderer::WriteAll(fd, timing.data(), timing.size())) {
+        logger.Log(WARNING, "Export: Could not write [%s]", timingPath.c_str());
+        success = false;
+    }
+
+    if (fd >= 0)
+        close(fd);
+
+    this->mFd = -1;
+    this->mStats.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    logger.Log(INFO, "Exported %zu frames (%zukB) to %s in %.1fms", this->mStats.Frames, this->mStats.Bytes / 1024,
+        directory.c_str(), this->mStats.Seconds * 1000);
+
+    return success;
+}
+
+void GifExporter::RenderFrame(const Canvas& frame)
+{
+    // One pixel per cell needs no filtering, the screen is drawn as it is
+    if (this->mScaler.Enabled()) {
+        this->mScaler.Scale(frame);
+        this->mRenderer.Render(this->mScaler.RGB(), this->mScaler.Glyphs());
+    } else {
+        this->mRenderer.Render(frame);
+    }
+}
+
+void GifExporter::Append(const char* data, size_t size)
+{
+    if (this->mFailed)
+        return;
+
+    if (this->mBuffered + size > this->mBuffer.size() && !Flush())
+        return;
+
+    // Anything as large as the whole buffer goes straight out instead of being copied first
+    if (size >= this->mBuffer.size()) {
+        this->mFailed = !Renderer::WriteAll(this->mFd, data, size);
+        this->mStats.Bytes += this->mFailed ? 0 : size;
+        return;
+    }
+
+    memcpy(this->mBuffer.data() + this->mBuffered, data, size);
+    this->mBuffered += size;
+}
+
+bool GifExporter::Flush()
+{
+    if (!this->mFailed && this->mBuffered > 0) {
+        this->mFailed = !Renderer::WriteAll(this->mFd, this->mBuffer.data(), this->mBuffered);
+        this->mStats.Bytes += this->mFailed ? 0 : this->mBuffered;
+    }
+
+    this->mBuffered = 0;
+    return !this->mFailed;
+}
@@ -0,0 +1,54 @@
+#include "framecache.hpp"
+
+FrameCache::FrameCache(size_t _capacity)
+{
+    this->mCapacity = (_capacity == 0) ? 1 : _capacity;
+}
+
+const Canvas* FrameCache::Find(size_t index)
+{
+    auto entry = this->mLookup.find(index);
+    if (entry == this->mLookup.end())
+        return nullptr;
+
+    this->mEntries.splice(this->mEntries.begin(), this->mEntries, entry->second);
+    return &entry->second->second;
+}
+
+const Canvas& FrameCache::Insert(size_t index, const Canvas& canvas)
+{
+    auto entry = this->mLookup.find(index);
+    if (entry != this->mLookup.end()) {
+        this->mEntries.splice(this->mEntries.begin(), this->mEntries, entry->second);
+        entry->second->second = canvas;
+        return entry->second->second;
+    }
+
+    if (this->mEntries.size() >= this->mCapacity) {
+        // Recycle the least recently used entry, its lookup node is moved over to the new index
+        // instead of being freed and allocated again
+        auto node = this->mLookup.extract(this->mEntries.back().first);
+        this->mEntries.splice(this->mEntries.begin(), this->mEntries, std::prev(this->mEntries.end()));
+        this->mEntries.front().first = index;
+        this->mEntries.front().second = canvas;
+
+        node.key() = index;
+        node.mapped() = this->mEntries.begin();
+        this->mLookup.insert(std::move(node));
+    } else {
+        this->mEntries.emplace_front(index, canvas);
+        this->mLookup[index] = this->mEntries.begin();
+    }
+
+    return this->mEntries.front().second;
+}
+
+void FrameCache::SetCapacity(size_t capacity)
+{
+    this->mCapacity = (capacity == 0) ? 1 : capacity;
+
+    while (this->mEntries.size() > this->mCapacity) {
+        this->mLookup.erase(this->mEntries.back().first);
+        this->mEntries.pop_back();
+    }
+}
@@ -0,0 +1,109 @@
+#include "frameindex.hpp"
+#include "imagemeta.hpp"
+#include "subblock.hpp"
+#include "utils/logger.hpp"
+
+FrameIndex::FrameIndex()
+{
+    this->mTotalDuration = 0;
+}
+
+bool FrameIndex::Scan(ByteStream* stream, const Color* colorTable, uint16_t colorCount, PaletteSet* palettes)
+{
+    logger.Log(TRACE, "Scanning frames");
+    Clear();
+
+    // Graphics control extensions apply to the next image descriptor in the stream
+    GraphicsControlExtension control = {};
+    size_t frameOffset = stream->Tell();
+
+    while (true) {
+        int nextByte = stream->Peek();
+
+        if (nextByte == EXTENSION_INTRODUCER) {
+            ExtensionHeader header = {};
+            stream->Read(&header, sizeof(ExtensionHeader));
+
+            if (header.Label == ExtensionLabel::GraphicsControl) {
+                control.Header = header;
+                stream->Read(&control.BlockSize, sizeof(GraphicsControlExtension) - sizeof(ExtensionHeader));
+            } else {
+                SkipSubBlocks(stream);
+            }
+        } else if (nextByte == IMAGE_DESCRIPTOR_SEPERATOR) {
+            ImageDescriptor descriptor = {};
+            stream->Read(&descriptor, sizeof(ImageDescriptor));
+
+            FrameInfo info = Describe(descriptor, control, frameOffset);
+            info.ColorTable = colorTable;
+            info.ColorCount = colorCount;
+
+            // The local color table is only a few hundred bytes and the frame needs it to be drawn
+            if (info.LocalColorTable) {
+                Color colors[PALETTE_MAX_COLORS] = {};
+                info.ColorCount = 2 << ((descriptor.Packed >> (uint8_t)ImgDescMask::IMGSize) & 0x07);
+                stream->Read(colors, info.ColorCount * COLOR_SIZE);
+                info.ColorTable = palettes->Intern(colors, info.ColorCount);
+            }
+
+            Add(info);
+
+            // Skip the LZW minimum code size and the image data
+            stream->Skip(sizeof(uint8_t));
+            SkipSubBlocks(stream);
+
+            control = {};
+            frameOffset = stream->Tell();
+        } else if (nextByte == TRAILER) {
+            logger.Log(SUCCESS, "Scanned %d frames", (int)this->mFrames.size());
+            return true;
+        } else {
+            logger.Log(WARNING, "Scan stopped on unexpected byte [%X]", nextByte);
+            return false;
+        }
+    }
+}
+
+FrameInfo FrameIndex::Describe(const Image& img, size_t offset)
+{
+    FrameInfo info = Describe(img.mDescriptor, img.mExtensions.GraphicsControl, offset);
+    info.ColorTable = img.mColorTable;
+    info.ColorCount = img.mColorTableSize;
+    return info;
+}
+
+FrameInfo FrameIndex::Describe(const ImageDescriptor& descriptor, const GraphicsControlExtension& control, size_t offset)
+{
+    FrameInfo info = {};
+    info.Offset = offset;
+    info.Left = descriptor.Left;
+    info.Top = descriptor.Top;
+    info.Width = descriptor.Width;
+    info.Height = descriptor.Height;
+    info.DelayTime = control.DelayTime;
+    info.Disposal = (control.Packed >> (uint8_t)GCEMask::Disposal) & 0x07;
+    info.Transparent = (control.Packed >> (uint8_t)GCEMask::TransparentColor) & 0x01;
+    info.TransparentColorIndex = control.TransparentColorIndex;
+    info.LocalColorTable = (descriptor.Packed >> (uint8_t)ImgDescMask::LocalColorTable) & 0x01;
+
+    return info;
+}
+
+void FrameIndex::Add(const FrameInfo& info)
+{
+    this->mFrames.push_back(info);
+    this->mTotalDuration += (uint64_t)info.DelayTime * 10;
+}
+
+void FrameIndex::Clear()
+{
+    this->mFrames.clear();
+    this->mTotalDuration = 0;
+}
+
+void FrameIndex::SkipSubBlocks(ByteStream* stream)
+{
+    uint8_t size = 0;
+    if (stream->Read(&size, sizeof(uint8_t)) == 1)
+        SubBlockReader(stream, size).Skip();
+}
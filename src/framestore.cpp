@@ -0,0 +1,76 @@
+#include "framestore.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+
+FrameStore::FrameStore(size_t _keyframeInterval)
+{
+    this->mKeyframeInterval = (_keyframeInterval == 0) ? 1 : _keyframeInterval;
+    Clear();
+}
+
+void FrameStore::Add(const Canvas& screen)
+{
+    size_t index = this->mEntries.size();
+    this->mEntries.emplace_back();
+    Entry& entry = this->mEntries.back();
+    entry.Area = {};
+
+    size_t screenSize = (size_t)screen.Width() * screen.Height();
+    bool keyframe = this->mKeyframes.empty()
+                 || this->mDeltaBytes >= screenSize
+                 || index - this->mKeyframes.back() >= this->mKeyframeInterval;
+
+    if (keyframe) {
+        entry.Pixels = screen;
+        this->mLast = screen;
+        this->mKeyframes.push_back(index);
+        this->mDeltaBytes = 0;
+    } else {
+        entry.Area = screen.Diff(this->mLast);
+        if (!entry.Area.Empty()) {
+            entry.Pixels.Crop(screen, entry.Area);
+            this->mLast.CopyRect(screen, entry.Area);
+            this->mDeltaBytes += (size_t)entry.Area.Width * entry.Area.Height;
+        }
+    }
+
+    this->mBytes += entry.Pixels.Capacity();
+}
+
+const Canvas& FrameStore::Get(size_t index)
+{
+    if (index >= this->mEntries.size())
+        throw std::out_of_range("FrameStore: frame index out of range");
+
+    // Last keyframe at or before the frame
+    size_t keyframe = *(std::upper_bound(this->mKeyframes.begin(), this->mKeyframes.end(), index) - 1);
+
+    // Start over from the keyframe unless the last frame returned is already on the way there
+    size_t start = this->mCurrentIndex;
+    if (start == SIZE_MAX || start > index || start < keyframe) {
+        start = keyframe;
+        this->mCurrent = this->mEntries.at(keyframe).Pixels;
+    }
+
+    for (size_t i = start + 1; i <= index; i++) {
+        const Entry& entry = this->mEntries.at(i);
+        if (!entry.Area.Empty())
+            this->mCurrent.Blit(entry.Pixels, entry.Area.Left, entry.Area.Top);
+    }
+
+    this->mCurrentIndex = index;
+    return this->mCurrent;
+}
+
+void FrameStore::Clear()
+{
+    this->mEntries.clear();
+    this->mKeyframes.clear();
+    this->mBytes = 0;
+    this->mDeltaBytes = 0;
+    this->mLast = Canvas();
+    this->mCurrent = Canvas();
+    this->mCurrentIndex = SIZE_MAX;
+}
@@ -2,8 +2,13 @@
 #include "gifmeta.hpp"
 #include "imagemeta.hpp"
 #include "lzw.hpp"
+#include "stream.hpp"
+#include "subblock.hpp"
 #include "utils/logger.hpp"
 #include "utils/error.hpp"
+#include "utils/definitions.hpp"
+#include "utils/queue.hpp"
+#include "utils/threadpool.hpp"
 
 #include <cstdint>
 #include <unistd.h>
@@ -11,46 +16,106 @@
 #include <math.h>
 #include <unordered_map>
 #include <string.h>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
 
-GIF::GIF(const char* _filepath)
+GIF::GIF(const char* _filepath, StreamBackend _backend)
+    : mFrameCache(LAZY_DEFAULT_CACHE_SIZE)
 {
-    this->mFile = fopen(_filepath, "rb");
+    this->mStream = new ByteStream(_filepath, _backend);
 
-    if (this->mFile == NULL)
+    // The destructor does not run for a constructor that throws
+    if (!this->mStream->IsOpen()) {
+        delete this->mStream;
         error(Severity::high, "Error opening file:", _filepath);
-    else
+    } else {
         logger.Log(DEBUG, "Opened [%s]", _filepath); 
+    }
+
+    Initialize();
+}
+
+GIF::GIF(const uint8_t* _data, size_t _size)
+    : mFrameCache(LAZY_DEFAULT_CACHE_SIZE)
+{
+    this->mStream = new ByteStream(_data, _size);
+
+    if (!this->mStream->IsOpen()) {
+        delete this->mStream;
+        error(Severity::high, "GIF:", "No data to read from");
+    } else {
+        logger.Log(DEBUG, "Reading from memory");
+    }
+
+    Initialize();
+}
 
-    // Get the file size and restore the file pointer back to position 0
-    fseek(this->mFile, 0, SEEK_END);
-    this->mFilesize = ftell(this->mFile);
-    rewind(this->mFile);
+GIF::~GIF()
+{
+    delete this->mStream;
+}
+
+void GIF::Initialize()
+{
+    this->mFilesize = this->mStream->Size();
     logger.Log(INFO, "Total file size: %dkB", this->mFilesize / 1024);
    
     // Initialize class members
     this->mHeader = {};
     this->mLsd = {};
-    this->mImageData = std::vector<Image>();
-    this->mFrameMap = std::vector<std::vector<char>>();
-    this->mPixelMap = std::vector<char>();
-    this->mPrevPixelMap = std::vector<char>();
+    this->mGctd = {};
+    this->mPalettes.Clear();
+    this->mFrameStore.Clear();
+    this->mCompositor = Compositor();
+    this->mComposited = -1;
+    this->mColorTable = nullptr;
     this->mFrameMapInitialized = false;
     this->mLSDInitialized = false;
+    this->mDecodeThreads = 1;
+    this->mLazy = false;
+    this->mKeyframeInterval = LAZY_DEFAULT_KEYFRAME_INTERVAL;
 }
 
 void GIF::Read()
 {
     logger.Log(DEBUG, "Reading GIF Information");
+
+    // Lazy GIFs only need the frame table, frames are decoded when they are asked for
+    if (this->mLazy) {
+        Scan();
+        this->mFrameMapInitialized = true;
+    } else {
+        LoadHeader();
+        LoadLSD();
+        GenerateFrameMap();
+        logger.Log(INFO, "Stored %zu frames in %zukB", this->mFrameStore.Count(), this->mFrameStore.Bytes() / 1024);
+    }
+
+    logger.Log(DEBUG, "%zu distinct palettes", this->mPalettes.Count());
+
+    const ArenaStats& stats = this->mArena.Stats();
+    logger.Log(DEBUG, "Read GIF Information, %zu heap allocations for decode state (%zu in the last frame)",
+        stats.Allocations, stats.LastFrameAllocations);
+}
+
+void GIF::Scan()
+{
+    logger.Log(DEBUG, "Scanning GIF Information");
     LoadHeader();
     LoadLSD();
-    GenerateFrameMap();
-    logger.Log(DEBUG, "Read GIF Information");
+
+    if (!this->mIndex.Scan(this->mStream, this->mColorTable, this->mGctd.NumberOfColors, &this->mPalettes))
+        logger.Log(WARNING, "File ended unaturally without a trailer");
+
+    logger.Log(INFO, "Frames: %d, Duration: %lums", (int)this->mIndex.Count(), (unsigned long)this->mIndex.TotalDuration());
 }
 
 void GIF::LoadHeader()
 {
     // Load the GIF header into memory
-    fread(&this->mHeader, sizeof(uint8_t), sizeof(GifHeader), this->mFile);
+    this->mStream->Read(&this->mHeader, sizeof(GifHeader));
 
     logger.Log(TRACE, "Checking for valid GIF Header");
     if (!ValidHeader())
@@ -69,7 +134,7 @@ void GIF::LoadLSD()
     logger.Log(TRACE, "Loading Logical Screen Descriptor");
 
     //Load the LSD From GIF File 
-    fread(&this->mLsd, sizeof(uint8_t), sizeof(LogicalScreenDescriptor), this->mFile);
+    this->mStream->Read(&this->mLsd, sizeof(LogicalScreenDescriptor));
 
     logger.Log(TRACE, "Checking for GCT flag");
     if (this->mLsd.Packed >> (int)LSDMask::GlobalColorTable) {
@@ -81,13 +146,13 @@ void GIF::LoadLSD()
         this->mGctd.NumberOfColors = pow(2, this->mGctd.SizeInLSD + 1);
         this->mGctd.ByteLegth = 3 * this->mGctd.NumberOfColors;
 
-        // Generate the GCT from each color present in file
-        this->mColorTable = new Color[this->mGctd.NumberOfColors];
-        for (int i = 0; i < this->mGctd.NumberOfColors; i++) {
-            Color color = NULL_COLOR;
-            fread(&color, sizeof(uint8_t), COLOR_SIZE, this->mFile);
-            this->mColorTable[i] = color; 
-        }
+        // Generate the GCT from each color present in file, colors are stored
+        // back to back in the file so the whole table is read at once
+        Color colors[PALETTE_MAX_COLORS] = {};
+        this->mStream->Read(colors, this->mGctd.NumberOfColors * COLOR_SIZE);
+
+        // Local tables holding the same colors end up as the same palette
+        this->mColorTable = this->mPalettes.Intern(colors, this->mGctd.NumberOfColors);
 
         logger.Log(SUCCESS, "Loaded GCTD");
         PrintColorTable();
@@ -109,55 +174,252 @@ void GIF::GenerateFrameMap()
         error(Severity::medium, "GIF:", "Attempted to initialize frame map before Logical Screen Descriptor");
 
     logger.Log(TRACE, "Generating Frame Map");
-    uint8_t nextByte;
     
-    // The pixel map will be initialized as a single vector
-    // to mimic a two dimensional array, elements are accessed like so
-    // (char) pixel = PixelMap.at(ROW * width) + COL
-    this->mPixelMap.resize(this->mLsd.Width * this->mLsd.Height);
-
-    // Initialize pixel map with blank characters
-    for (int row = 0; row < this->mLsd.Height; row++) {
-        for (int col = 0; col < this->mLsd.Width; col++) {
-            this->mPixelMap.at((row * this->mLsd.Width) + col) = ' ';
-        }
+    ResetPixelMap();
+
+    if (this->mDecodeThreads > 1) {
+        GenerateFrameMapParallel();
+        this->mFrameMapInitialized = true;
+        return;
     }
 
     // Build up each frame for the gif
     while (true) {
-        Image img = Image(this->mFile, this->mColorTable, this->mGctd.NumberOfColors);
+        Image img = Image(this->mStream, this->mColorTable, this->mGctd.NumberOfColors, &this->mArena, &this->mPalettes);
+        size_t offset = this->mStream->Tell();
 
         // Load Image Extenstion information before proceeding with parsing image data
         img.CheckExtensions();
         
         // Load the decompressed image data and draw the frame
         logger.Log(DEBUG, "Loading Image Data");
-        std::string rasterData = img.LoadImageData();
+        const Canvas& rasterData = img.LoadImageData(PreviewFor(img, this->mIndex.Count()));
+        this->mIndex.Add(FrameIndex::Describe(img, offset));
+        CompositeFrame(img, rasterData);
+        this->mArena.Reset();
 
-        this->mPrevPixelMap = this->mPixelMap; 
-        img.UpdatePixelMap(&this->mPixelMap, &this->mPrevPixelMap, &rasterData, &this->mLsd);
-        this->mFrameMap.push_back(this->mPixelMap);
-        this->mImageData.push_back(img);
-
-        fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
-        fseek(this->mFile, -1, SEEK_CUR);
-        
-        // Check if the file ended correctly (should end on 0x3B)
-        if ((size_t)ftell(this->mFile) == this->mFilesize - 1) {
-            if (nextByte == TRAILER)
-                logger.Log(SUCCESS, "File ended naturally");
-            else
-                logger.Log(WARNING, "File ended unaturally with byte [%c]", nextByte);
-
-            // There is nothing left to get from the file so close it
-            fclose(this->mFile);
+        if (EndOfFrames())
             break;
-        }
     }
     
     this->mFrameMapInitialized = true;
 }
 
+void GIF::ResetPixelMap()
+{
+    // The background index points into the global table, without one (or past its end) the screen starts out black
+    Color background = NULL_COLOR;
+    if (this->mColorTable != nullptr && this->mLsd.BackgroundColorIndex < this->mGctd.NumberOfColors)
+        background = this->mColorTable[this->mLsd.BackgroundColorIndex];
+
+    this->mCompositor.Reset(this->mLsd.Width, this->mLsd.Height, background);
+    this->mComposited = -1;
+}
+
+void GIF::SetLazy(size_t cacheSize, size_t keyframeInterval)
+{
+    this->mLazy = true;
+    this->mFrameCache.SetCapacity(cacheSize);
+    this->mKeyframeInterval = (keyframeInterval == 0) ? 1 : keyframeInterval;
+}
+
+void GIF::AddKeyframe(size_t index)
+{
+    this->mCompositor.Base(&this->mKeyframes[index]);
+    if (this->mKeyframes.size() <= LAZY_MAX_KEYFRAMES || this->mKeyframeInterval > SIZE_MAX / 2)
+        return;
+
+    // The keyframes left are still every mKeyframeInterval'th frame, so seeking works the same way
+    this->mKeyframeInterval *= 2;
+    for (auto keyframe = this->mKeyframes.begin(); keyframe != this->mKeyframes.end();) {
+        if (keyframe->first % this->mKeyframeInterval != 0)
+            keyframe = this->mKeyframes.erase(keyframe);
+        else
+            keyframe++;
+    }
+
+    logger.Log(DEBUG, "Keyframes thinned out to every %zu frames", this->mKeyframeInterval);
+}
+
+void GIF::SetProgressive(ProgressHandler handler)
+{
+    this->mProgressive = std::move(handler);
+}
+
+PreviewHandler GIF::PreviewFor(Image& img, size_t index)
+{
+    if (!this->mProgressive)
+        return nullptr;
+
+    return [this, &img, index](const Canvas& coarse) {
+        this->mCompositor.Preview(FrameIndex::Describe(img, 0), coarse, &this->mPreviewMap);
+        this->mProgressive(index, this->mPreviewMap);
+    };
+}
+
+size_t GIF::FrameCount() const
+{
+    return this->mIndex.Count();
+}
+
+const Canvas& GIF::GetFrame(size_t index)
+{
+    if (index >= this->mIndex.Count())
+        error(Severity::medium, "GIF:", "Frame index out of range");
+
+    if (!this->mLazy)
+        return this->mFrameStore.Get(index);
+
+    const Canvas* cached = this->mFrameCache.Find(index);
+    if (cached != nullptr)
+        return *cached;
+
+    // Frames are drawn over the ones before them, so decoding has to start from the closest
+    // screen already known, either a keyframe or (during playback) the frame decoded last
+    // A keyframe holds the screen after its frame was disposed of, so it has to come before the frame asked for
+    long start = -1;
+    auto keyframe = this->mKeyframes.lower_bound(index);
+    if (keyframe != this->mKeyframes.begin()) {
+        keyframe--;
+        start = keyframe->first;
+    }
+
+    if (this->mComposited >= 0 && this->mComposited >= start && this->mComposited < (long)index) {
+        // The compositor still holds the frame and how to dispose of it, nothing has to be copied
+        start = this->mComposited;
+    } else if (start >= 0) {
+        this->mCompositor.Restart(keyframe->second);
+    } else {
+        ResetPixelMap();
+    }
+
+    for (size_t i = start + 1; i <= index; i++) {
+        // Parsing the few header bytes again is cheaper than keeping every frame's Image around
+        this->mStream->Seek(this->mIndex[i].Offset);
+        Image img = Image(this->mStream, this->mColorTable, this->mGctd.NumberOfColors, &this->mArena, &this->mPalettes);
+        img.CheckExtensions();
+
+        // Frames before the one asked for are only decoded to be drawn over, nobody sees them
+        const Canvas& rasterData = img.LoadImageData((i == index) ? PreviewFor(img, i) : nullptr);
+        DrawFrame(img, rasterData);
+        this->mComposited = i;
+        this->mArena.Reset();
+
+        if (i % this->mKeyframeInterval == 0 && this->mKeyframes.count(i) == 0)
+            AddKeyframe(i);
+    }
+
+    return this->mFrameCache.Insert(index, this->mCompositor.Screen());
+}
+
+void GIF::GenerateFrameMapParallel()
+{
+    logger.Log(DEBUG, "Decoding frames on %d threads", this->mDecodeThreads);
+
+    struct PendingFrame {
+        Image Img;
+        std::future<Canvas> RasterData;
+    };
+
+    ThreadPool pool(this->mDecodeThreads);
+
+    // Keep a couple of frames per worker in flight so no worker waits on the parser,
+    // without letting the parser run arbitrarily far ahead of the compositor
+    BoundedQueue<std::unique_ptr<PendingFrame>> pending(pool.Size() * 2);
+
+    // An error on the parser thread is thrown again once it has been joined
+    std::exception_ptr parserError;
+
+    // Parser stage, splits the stream into the compressed data of each frame
+    std::thread parser([this, &pool, &pending, &parserError] {
+        try {
+            while (true) {
+                Image img = Image(this->mStream, this->mColorTable, this->mGctd.NumberOfColors, &this->mArena, &this->mPalettes);
+                size_t offset = this->mStream->Tell();
+                img.CheckExtensions();
+                img.LoadDescriptor();
+                this->mIndex.Add(FrameIndex::Describe(img, offset));
+
+                std::vector<uint8_t> data;
+                img.ReadCompressedData(&data);
+
+                // Decode stage, runs on whichever worker is free
+                std::future<Canvas> rasterData = pool.Submit([img, data = std::move(data)] {
+                    return img.DecodeImageData(data);
+                });
+
+                pending.Push(std::unique_ptr<PendingFrame>(new PendingFrame{img, std::move(rasterData)}));
+                this->mArena.Reset();
+
+                if (EndOfFrames())
+                    break;
+            }
+        } catch (...) {
+            parserError = std::current_exception();
+        }
+
+        pending.Close();
+    });
+
+    // Compositor stage, disposal methods depend on the previous frame so frames are drawn in order
+    std::exception_ptr compositorError;
+    std::unique_ptr<PendingFrame> frame;
+    while (pending.Pop(frame)) {
+        if (compositorError)
+            continue;
+
+        // After an error the queue is still drained so the parser is never left waiting on it
+        try {
+            Canvas rasterData = frame->RasterData.get();
+            CompositeFrame(frame->Img, rasterData);
+        } catch (...) {
+            compositorError = std::current_exception();
+        }
+    }
+
+    parser.join();
+
+    if (parserError)
+        std::rethrow_exception(parserError);
+    if (compositorError)
+        std::rethrow_exception(compositorError);
+}
+
+void GIF::DrawFrame(Image& img, const Canvas& rasterData)
+{
+    this->mCompositor.Draw(FrameIndex::Describe(img, 0), rasterData);
+}
+
+void GIF::CompositeFrame(Image& img, const Canvas& rasterData)
+{
+    DrawFrame(img, rasterData);
+    this->mFrameStore.Add(this->mCompositor.Screen());
+}
+
+bool GIF::EndOfFrames()
+{
+    int nextByte = this->mStream->Peek();
+    
+    // Check if the file ended correctly (should end on 0x3B)
+    if (nextByte != TRAILER && nextByte >= 0)
+        return false;
+
+    if (nextByte == TRAILER)
+        logger.Log(SUCCESS, "File ended naturally");
+    else
+        logger.Log(WARNING, "File ended unaturally without a trailer");
+
+    // There is nothing left to get from the file so close it
+    delete this->mStream;
+    this->mStream = nullptr;
+    return true;
+}
+
+void GIF::SetDecodeThreads(unsigned int threads)
+{
+    this->mDecodeThreads = (threads == 0) ? 1 : threads;
+}
+
 bool GIF::ValidHeader()
 {
     for (int i = 0; i < 3; i++) {
@@ -177,8 +439,11 @@ bool GIF::ValidHeader()
 
 void GIF::SigIntHandler(int sig)
 {
-    system("clear");        
-    exit(0);
+    // Reset the colors, clear the screen and bring the cursor back,
+    // system() is not safe to call from inside of a signal handler
+    const char restore[] = "\x1b[0m\x1b[2J\x1b[H\x1b[?25h";
+    UNUSED ssize_t result = write(STDOUT_FILENO, restore, sizeof(restore) - 1);
+    _exit(0);
 }
 
 void GIF::PrintHeaderInfo()
@@ -0,0 +1,115 @@
+#include "gif2ascii.hpp"
+#include "utils/error.hpp"
+
+FrameIterator::FrameIterator(GifDecoder* _decoder, size_t _index)
+{
+    this->mDecoder = _decoder;
+    this->mIndex = _index;
+    this->mFrame = {};
+    this->mLoaded = false;
+}
+
+const FrameView& FrameIterator::operator*() const
+{
+    if (!this->mLoaded) {
+        this->mFrame = this->mDecoder->Frame(this->mIndex);
+        this->mLoaded = true;
+    }
+
+    return this->mFrame;
+}
+
+FrameIterator& FrameIterator::operator++()
+{
+    this->mIndex++;
+    this->mLoaded = false;
+    return *this;
+}
+
+GifDecoder::GifDecoder(const char* _filepath)
+    : mGIF(_filepath)
+{
+    Initialize();
+}
+
+GifDecoder::GifDecoder(const uint8_t* _data, size_t _size)
+    : mGIF(_data, _size)
+{
+    Initialize();
+}
+
+void GifDecoder::Initialize()
+{
+    // Frames are decoded as they are asked for, the one before the current frame is kept
+    // so walking forward decodes each frame once and keyframes make seeking cheap
+    this->mGIF.SetLazy();
+    this->mGIF.Read();
+
+    const FrameIndex& index = this->mGIF.Index();
+    this->mTimestamps.resize(index.Count());
+
+    uint64_t timestamp = 0;
+    for (size_t i = 0; i < index.Count(); i++) {
+        this->mTimestamps[i] = timestamp;
+        timestamp += index[i].DelayTime * 10;
+    }
+}
+
+FrameView GifDecoder::Frame(size_t index)
+{
+    if (index >= FrameCount())
+        error(Severity::medium, "GifDecoder:", "Frame index out of range");
+
+    const FrameInfo& info = this->mGIF.Index()[index];
+
+    FrameView frame = {};
+    frame.Index = index;
+    frame.Pixels = &this->mGIF.GetFrame(index);
+    frame.ColorTable = info.ColorTable;
+    frame.ColorCount = info.ColorCount;
+    frame.DelayMs = info.DelayTime * 10;
+    frame.TimestampMs = this->mTimestamps[index];
+    return frame;
+}
+
+// Pixel grid the frames are scaled into, half blocks stack two pixels that are half as tall in every cell
+static Scaler FitOptions(const GifDecoder& decoder, const RenderOptions& options)
+{
+    uint16_t rows = options.Rows;
+    float cellAspect = options.CellAspect;
+    if (options.Cells == CellMode::HalfBlock) {
+        rows *= 2;
+        cellAspect /= 2;
+    }
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    Scaler::Fit(decoder.Width(), decoder.Height(), options.Columns, rows, cellAspect, &width, &height);
+
+    return Scaler(decoder.Width(), decoder.Height(), width, height);
+}
+
+FrameRenderer::FrameRenderer(const GifDecoder& _decoder, const RenderOptions& _options)
+    : mScaler(FitOptions(_decoder, _options)),
+      mRenderer(mScaler.Width(), mScaler.Height(), _options.Mode, _options.Cells)
+{
+}
+
+void FrameRenderer::Render(const FrameView& frame, std::string* output)
+{
+    // One pixel per cell needs no filtering, the screen is drawn as it is
+    if (this->mScaler.Enabled()) {
+        this->mScaler.Scale(*frame.Pixels);
+        this->mRenderer.Render(this->mScaler.RGB(), this->mScaler.Glyphs());
+    } else {
+        this->mRenderer.Render(*frame.Pixels);
+    }
+
+    output->assign(this->mRenderer.Data(), this->mRenderer.Size());
+}
+
+void FrameRenderer::Invalidate()
+{
+    this->mScaler.Invalidate();
+    this->mRenderer.Invalidate();
+}
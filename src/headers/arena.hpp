@@ -0,0 +1,83 @@
+#pragma once
+#ifndef _ARENA_HPP
+#define _ARENA_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include "canvas.hpp"
+
+// Size of the blocks the arena hands memory out of, larger requests get a block of their own
+#define ARENA_BLOCK_SIZE (16 * 1024)
+
+struct ArenaStats {
+    size_t Frames;                  // Number of times the arena was reset for a new frame
+    size_t Allocations;             // Heap allocations made by the arena since it was created
+    size_t LastFrameAllocations;    // Heap allocations made while decoding the last frame
+    size_t Bytes;                   // Memory held by the arena
+};
+
+// Memory for the short lived state of a frame (extension data and the decoded raster).
+// Everything handed out stays valid until the next Reset(), after which the same memory
+// is handed out again, so once the arena has grown to fit the largest frame decoding allocates nothing.
+// An arena belongs to a single decoder and is not shared between threads
+class DecodeArena
+{
+    public:
+        DecodeArena();
+
+        DecodeArena(const DecodeArena&) = delete;
+        DecodeArena& operator=(const DecodeArena&) = delete;
+
+        /**
+         * Get memory for the current frame
+         *
+         * @param size - Number of bytes needed
+         * @return Memory valid until the next Reset()
+         */
+        uint8_t* Allocate(size_t size);
+
+        /**
+         * Get the canvas a frame is decoded into, resized in place (rows are not padded)
+         *
+         * @param width - Width of the frame
+         * @param height - Height of the frame
+         * @return Canvas valid until the next call
+         */
+        Canvas& Raster(uint16_t width, uint16_t height);
+
+        // Same as Raster() for the coarse preview of an interlaced frame
+        Canvas& Preview(uint16_t width, uint16_t height);
+
+        /**
+         * Move on to the next frame, every allocation made so far is reused
+         *
+         * @return NONE
+         */
+        void Reset();
+
+        const ArenaStats& Stats() const { return this->mStats; }
+
+    private:
+        struct Block {
+            std::unique_ptr<uint8_t[]> Data;
+            size_t Size;
+        };
+
+        std::vector<Block> mBlocks;
+        size_t mBlock;      // Block allocations are currently made from
+        size_t mUsed;       // Bytes used in that block
+
+        Canvas mRaster;
+        Canvas mPreview;
+
+        ArenaStats mStats;
+        size_t mFrameStartAllocations;
+
+    private:
+        void AddBlock(size_t size);
+        Canvas& Reuse(Canvas& canvas, uint16_t width, uint16_t height);
+};
+
+#endif // _ARENA_HPP
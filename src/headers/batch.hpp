@@ -0,0 +1,88 @@
+#pragma once
+#ifndef _BATCH_HPP
+#define _BATCH_HPP
+
+#include <stddef.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "renderer.hpp"
+
+// Extension of the files written by a batch conversion
+#define BATCH_OUTPUT_EXTENSION ".ans"
+
+// Largest screen (or frame) converted, in pixels. Frames are drawn a cell per pixel and the renderer
+// sizes its buffer for the worst case of ~56 bytes per cell, so this is already a 230MB buffer
+#define BATCH_MAX_PIXELS (2048 * 2048)
+
+struct BatchResult {
+    std::string Input;
+    std::string Output;
+    bool        Success;
+    size_t      Frames;
+    size_t      BytesIn;
+    size_t      BytesOut;
+    double      Seconds;
+};
+
+class BatchConverter
+{
+    public:
+        /**
+         * Convert many GIFs into ANSI files, each GIF is decoded and rendered
+         * on its own worker so files are processed side by side
+         *
+         * @param _outputDir - Directory the converted files are written to
+         * @param _threads - Number of files converted at the same time
+         * @param _mode - Repaint every cell of every frame or only the changed ones
+         * @param _cells - Draw one pixel per cell as a glyph or two pixels per cell as a half block
+         */
+        BatchConverter(const std::string& _outputDir, unsigned int _threads, RenderMode _mode = RenderMode::Delta,
+                       CellMode _cells = CellMode::Glyph);
+
+        /**
+         * Queue a GIF, directories are expanded into the .gif files directly inside of them
+         *
+         * @param path - File or directory
+         * @return NONE
+         */
+        void Add(const std::string& path);
+
+        /**
+         * Convert every queued file, printing a line per file as results come in
+         * followed by the totals
+         *
+         * @return Number of files that could not be converted
+         */
+        size_t Run();
+
+        const std::vector<BatchResult>& Results() const { return this->mResults; }
+
+    private:
+        std::string mOutputDir;
+        unsigned int mThreads;
+        RenderMode mMode;
+        CellMode mCells;
+
+        std::vector<std::string> mInputs;
+        std::vector<BatchResult> mResults;
+
+    private:
+        // Decode a single GIF and write all of its frames into the output file
+        BatchResult Convert(const std::string& input, const std::string& output) const;
+
+        /**
+         * Name the output file of an input after it, inputs with the same name (from different
+         * directories) get a numbered suffix so no two workers write to the same file
+         *
+         * @param input - Path of the GIF
+         * @param taken - Output paths handed out so far, receives the new one
+         * @return Path of the output file
+         */
+        std::string OutputPath(const std::string& input, std::unordered_set<std::string>* taken) const;
+
+        void PrintResult(const BatchResult& result);
+        void PrintSummary(double seconds);
+};
+
+#endif // _BATCH_HPP
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef _CANVAS_HPP
+#define _CANVAS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gifmeta.hpp"
+
+// Rows of a canvas start on a multiple of this many bytes
+#define CANVAS_ROW_ALIGNMENT 16
+
+// Area of a canvas, an empty rect has a width or height of 0
+struct Rect {
+    uint16_t Left;
+    uint16_t Top;
+    uint16_t Width;
+    uint16_t Height;
+
+    bool Empty() const { return Width == 0 || Height == 0; }
+};
+
+// Grid of pixels, either color table indices (decoded frames) or packed RGB (the composited screen).
+// Every operation works on whole pixels of the canvas's own format
+class Canvas
+{
+    public:
+        Canvas();
+
+        /**
+         * Create a canvas filled with a single index
+         *
+         * @param _width - Width in pixels
+         * @param _height - Height in pixels
+         * @param _fill - Index every pixel starts out as
+         * @param _stride - Bytes between the start of two rows, 0 pads rows to CANVAS_ROW_ALIGNMENT
+         */
+        Canvas(uint16_t _width, uint16_t _height, uint8_t _fill = 0, size_t _stride = 0);
+
+        void Resize(uint16_t width, uint16_t height, uint8_t fill = 0, size_t stride = 0);
+        void Fill(uint8_t index);
+
+        /**
+         * Become a canvas of packed RGB pixels (COLOR_SIZE bytes each) filled with a single color
+         *
+         * @param width - Width in pixels
+         * @param height - Height in pixels
+         * @param fill - Color every pixel starts out as
+         * @return NONE
+         */
+        void ResizeRGB(uint16_t width, uint16_t height, const Color& fill);
+
+        // Set every pixel inside of a rect of an RGB canvas to a single color
+        void FillRect(const Rect& rect, const Color& color);
+
+        /**
+         * Copy another canvas onto this one with its top left corner at (left, top),
+         * anything that falls outside of this canvas is cut off
+         *
+         * @return NONE
+         */
+        void Blit(const Canvas& source, uint16_t left, uint16_t top);
+
+        /**
+         * Find the smallest rect holding every pixel that differs from another canvas of the same size
+         *
+         * @return Bounding rect of the changes, empty if there are none
+         */
+        Rect Diff(const Canvas& other) const;
+
+        // Copy the pixels inside of a rect over from another canvas of the same size
+        void CopyRect(const Canvas& source, const Rect& rect);
+
+        // Become a copy of the pixels inside of a rect of another canvas (rows are not padded)
+        void Crop(const Canvas& source, const Rect& rect);
+
+        uint16_t Width() const { return this->mWidth; }
+        uint16_t Height() const { return this->mHeight; }
+        size_t Stride() const { return this->mStride; }
+        uint8_t PixelSize() const { return this->mPixelSize; }
+        size_t Capacity() const { return this->mPixels.capacity(); }
+        bool Empty() const { return this->mWidth == 0 || this->mHeight == 0; }
+
+        uint8_t* Data() { return this->mPixels.data(); }
+        const uint8_t* Data() const { return this->mPixels.data(); }
+
+        uint8_t* Row(uint16_t y) { return this->mPixels.data() + (y * this->mStride); }
+        const uint8_t* Row(uint16_t y) const { return this->mPixels.data() + (y * this->mStride); }
+
+        // Index of a single pixel, only for indexed canvases
+        uint8_t& At(uint16_t x, uint16_t y) { return this->mPixels[(y * this->mStride) + x]; }
+        uint8_t At(uint16_t x, uint16_t y) const { return this->mPixels[(y * this->mStride) + x]; }
+
+        // Only the pixels are compared, row padding is ignored
+        bool operator==(const Canvas& other) const;
+        bool operator!=(const Canvas& other) const { return !(*this == other); }
+
+    private:
+        uint16_t mWidth;
+        uint16_t mHeight;
+        size_t mStride;
+        uint8_t mPixelSize;     // Bytes per pixel, 1 for indices and COLOR_SIZE for RGB
+
+        std::vector<uint8_t> mPixels;
+
+    private:
+        void Allocate(uint16_t width, uint16_t height, uint8_t pixelSize, size_t stride);
+};
+
+#endif // _CANVAS_HPP
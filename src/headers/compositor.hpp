@@ -0,0 +1,95 @@
+#pragma once
+#ifndef _COMPOSITOR_HPP
+#define _COMPOSITOR_HPP
+
+#include <stdint.h>
+#include "canvas.hpp"
+#include "frameindex.hpp"
+
+// Disposal methods of the graphics control extension
+enum class Disposal : uint8_t {
+    None            = 0,    // Not specified, left in place like DoNotDispose
+    DoNotDispose    = 1,    // Leave the frame on the screen
+    Background      = 2,    // Clear the frame's area to the background color
+    Previous        = 3     // Put back what was under the frame before it was drawn
+};
+
+// Builds the screen a GIF shows by drawing its frames in order. The screen holds RGB, so every frame
+// is looked up in its own color table as it is drawn and frames with different tables can share it. A frame's disposal method is
+// carried out right before the next frame is drawn, so the screen always shows the last frame.
+// Only the area of a frame is ever copied, restoring to the previous state keeps just that area
+class Compositor
+{
+    public:
+        Compositor();
+
+        /**
+         * Start over from a screen filled with the background color
+         *
+         * @param width - Width of the logical screen
+         * @param height - Height of the logical screen
+         * @param background - Background color, already looked up in the global color table
+         * @return NONE
+         */
+        void Reset(uint16_t width, uint16_t height, const Color& background);
+
+        /**
+         * Start over from the screen a frame left behind once it was disposed of (see Base())
+         *
+         * @param base - Screen to draw the next frame over
+         * @return NONE
+         */
+        void Restart(const Canvas& base);
+
+        /**
+         * Dispose of the last frame and draw the next one over the screen,
+         * pixels of the frame's transparent index leave the screen as it is
+         *
+         * @param info - Position, color table, disposal and transparency of the frame
+         * @param raster - Decoded frame of color table indices, info.Width by info.Height
+         * @return NONE
+         */
+        void Draw(const FrameInfo& info, const Canvas& raster);
+
+        // Screen showing the last frame drawn
+        const Canvas& Screen() const { return this->mScreen; }
+
+        /**
+         * Copy the screen as the next frame will see it, with the last frame disposed of
+         *
+         * @param base - Receives the screen
+         * @return NONE
+         */
+        void Base(Canvas* base) const;
+
+        /**
+         * Copy what the screen would show with a frame drawn over it, without drawing it
+         * (used for the coarse preview of a frame that is still being decoded)
+         *
+         * @param info - Position, color table and transparency of the frame
+         * @param raster - Frame to draw, info.Width by info.Height
+         * @param preview - Receives the screen
+         * @return NONE
+         */
+        void Preview(const FrameInfo& info, const Canvas& raster, Canvas* preview) const;
+
+    private:
+        Canvas mScreen;
+        Color mBackground;
+
+        // Disposal of the last frame, carried out before the next one is drawn
+        Disposal mDisposal;
+        Rect mArea;
+
+        // What was under the last frame, kept only if it is disposed of by restoring it
+        Canvas mSaved;
+
+    private:
+        // Part of a frame that is on the screen, frames may reach past its edges
+        Rect Clip(const FrameInfo& info) const;
+
+        void Dispose(Canvas* screen) const;
+        static void DrawRaster(Canvas* screen, const Rect& area, const FrameInfo& info, const Canvas& raster);
+};
+
+#endif // _COMPOSITOR_HPP
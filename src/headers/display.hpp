@@ -3,19 +3,92 @@
 #define _GIF_DISPLAY_HPP
 
 #include "gif.hpp"
+#include "rendercache.hpp"
+#include "renderer.hpp"
+#include "scaler.hpp"
+#include "scheduler.hpp"
+
+/**
+ * Size the pixel grid a GIF is drawn into, frames are scaled down to fit a number of cells keeping their aspect
+ *
+ * @param gif - GIF to draw, its logical screen is the size of the frames
+ * @param columns - Columns available, 0 for no limit
+ * @param rows - Rows available, 0 for no limit
+ * @param cellAspect - Height of a terminal cell divided by its width
+ * @param cells - One pixel per cell or two stacked pixels per cell
+ * @return Scaler from the frames into the grid
+ */
+Scaler FitToCells(GIF* gif, uint16_t columns, uint16_t rows, float cellAspect, CellMode cells);
+
+/**
+ * Same as FitToCells() with the size of the terminal behind stdout (when it is one)
+ *
+ * @param gif - GIF to draw, its logical screen is the size of the frames
+ * @param cellAspect - Height of a terminal cell divided by its width
+ * @param cells - One pixel per cell or two stacked pixels per cell
+ * @return Scaler from the frames into the grid
+ */
+Scaler FitToTerminal(GIF* gif, float cellAspect, CellMode cells);
 
 class GifDisplay 
 {
     public:
-        GifDisplay(const GIF* _gif);
+        /**
+         * @param _gif - GIF to play, already read
+         * @param _mode - Repaint every cell of every frame or only the changed ones
+         * @param _cellAspect - Height of a terminal cell divided by its width, frames are scaled
+         *                      down to fit the terminal (when stdout is one) keeping this aspect
+         * @param _cells - Draw one pixel per cell as a glyph or two pixels per cell as a half block
+         */
+        GifDisplay(GIF* _gif, RenderMode _mode = RenderMode::Delta, float _cellAspect = DEFAULT_CELL_ASPECT,
+                   CellMode _cells = CellMode::Glyph);
         ~GifDisplay();
 
+        /**
+         * Decode frames on a thread of their own while playing instead of between frames,
+         * read the GIF lazily so only the frames waiting to be drawn are held in memory
+         *
+         * @param depth - Number of frames decoded ahead, 0 decodes on the display thread
+         * @return NONE
+         */
+        void SetDecodeAhead(size_t depth);
+
+        /**
+         * Keep the rendered output of every frame after the first loop so later loops only
+         * write it out again, frames are rendered live if the output does not fit
+         *
+         * @param bytes - Most memory the cached output may take up, 0 disables the cache
+         * @return NONE
+         */
+        void SetRenderCache(size_t bytes);
+
+        /**
+         * Draw the coarse first pass of interlaced frames while the rest of them is decoded,
+         * only for frames decoded on the display thread (not with SetDecodeAhead)
+         *
+         * @param enabled - True to draw previews
+         * @return NONE
+         */
+        void SetProgressive(bool enabled);
+
         void LoopFrames();
+
+        const PlaybackStats& Stats() const { return this->mScheduler.Stats(); }
         char ColorToChar(Color& color);
         
     private:
-        const GIF* mGIF;
+        GIF* mGIF;
         const char* mCharMap;
+        Scaler mScaler;
+        Renderer mRenderer;
+        FrameScheduler mScheduler;
+        size_t mDecodeAhead;
+        RenderCache mCache;
+        bool mProgressive;
+
+    private:
+        // Scale (if needed), render and write out a single frame
+        void DrawFrame(const Canvas& frame);
 };
 
 #endif // _GIF_DISPLAY_HPP
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef _EXPORT_HPP
+#define _EXPORT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "gif.hpp"
+#include "rendercache.hpp"
+#include "renderer.hpp"
+#include "scaler.hpp"
+
+// Output is collected into blocks of this size before it is written out
+#define EXPORT_BUFFER_SIZE (1 << 20)
+
+// Names of the files written by a frame per file export
+#define EXPORT_FRAME_FORMAT     "frame_%05zu.ans"
+#define EXPORT_TIMING_FILE      "timing.txt"
+
+// Timing marker written before every frame of a stream. APC strings are dropped by terminals,
+// so the stream still plays with cat while a player can read the delays out of it
+#define EXPORT_MARKER_FORMAT    "\x1b_gif2ascii;loop=%u;frame=%zu;delay=%u;time=%llu\x1b\\"
+#define EXPORT_MARKER_MAX_SIZE  96
+
+struct ExportOptions {
+    unsigned int    Loops       = 1;        // Passes over the frames written into a stream
+    bool            Timing      = false;    // Write a timing marker before every frame of a stream
+    RenderMode      Mode        = RenderMode::Delta;
+    CellMode        Cells       = CellMode::Glyph;
+    float           CellAspect  = DEFAULT_CELL_ASPECT;
+    uint16_t        Columns     = 0;        // Most columns / rows frames are drawn into, 0 for no limit.
+    uint16_t        Rows        = 0;        // The output never depends on the terminal it is made in
+    size_t          CacheBytes  = 0;        // Rendered output kept to replay loops after the second one
+};
+
+struct ExportStats {
+    size_t  Frames;     // Frames written, every loop counted
+    size_t  Bytes;
+    double  Seconds;
+};
+
+// Renders the frames of a GIF into files instead of the terminal, as fast as they can be
+// rendered instead of paced by their delays. The output is drawn the same way the display draws it
+class GifExporter
+{
+    public:
+        /**
+         * @param _gif - GIF to export, already read
+         * @param _options - Loops, timing markers and how frames are drawn
+         */
+        GifExporter(GIF* _gif, const ExportOptions& _options);
+
+        GifExporter(const GifExporter&) = delete;
+        GifExporter& operator=(const GifExporter&) = delete;
+
+        /**
+         * Write every frame into a single ANSI stream that plays the animation with cat,
+         * each loop after the first one draws over the last frame of the loop before it
+         *
+         * @param fd - Descriptor of the file or pipe
+         * @return True if the whole stream was written
+         */
+        bool WriteStream(int fd);
+
+        /**
+         * Write a single pass into a file per frame, every file draws its frame in full.
+         * The delay and start time of every frame goes into EXPORT_TIMING_FILE
+         *
+         * @param directory - Directory the files are written to, created if it does not exist
+         * @return True if every file was written
+         */
+        bool WriteFrames(const std::string& directory);
+
+        const ExportStats& Stats() const { return this->mStats; }
+
+    private:
+        GIF* mGIF;
+        ExportOptions mOptions;
+        Scaler mScaler;
+        Renderer mRenderer;
+        RenderCache mCache;
+
+        // Output waiting to be written, only written once full
+        std::vector<char> mBuffer;
+        size_t mBuffered;
+        int mFd;
+        bool mFailed;
+
+        ExportStats mStats;
+
+    private:
+        // Scale (if needed) and render a single frame into the renderer's buffer
+        void RenderFrame(const Canvas& frame);
+
+        void Append(const char* data, size_t size);
+        bool Flush();
+};
+
+#endif // _EXPORT_HPP
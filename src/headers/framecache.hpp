@@ -0,0 +1,45 @@
+#pragma once
+#ifndef _FRAME_CACHE_HPP
+#define _FRAME_CACHE_HPP
+
+#include <stddef.h>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "canvas.hpp"
+
+// Least recently used cache of composited frame canvases
+class FrameCache
+{
+    public:
+        FrameCache(size_t _capacity);
+
+        /**
+         * Look up the canvas of a frame and mark it as the most recently used
+         *
+         * @return Pointer to the canvas or nullptr if it is not cached
+         */
+        const Canvas* Find(size_t index);
+
+        /**
+         * Cache the canvas of a frame, evicting the least recently used one when full.
+         * The evicted canvas' buffer is reused so a full cache does not allocate
+         *
+         * @return Reference to the cached copy, valid until it is evicted
+         */
+        const Canvas& Insert(size_t index, const Canvas& canvas);
+
+        void SetCapacity(size_t capacity);
+        size_t Capacity() const { return this->mCapacity; }
+        size_t Size() const { return this->mEntries.size(); }
+
+    private:
+        size_t mCapacity;
+
+        // Most recently used entries are kept at the front
+        std::list<std::pair<size_t, Canvas>> mEntries;
+        std::unordered_map<size_t, std::list<std::pair<size_t, Canvas>>::iterator> mLookup;
+};
+
+#endif // _FRAME_CACHE_HPP
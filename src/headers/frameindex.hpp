@@ -0,0 +1,73 @@
+#pragma once
+#ifndef _FRAME_INDEX_HPP
+#define _FRAME_INDEX_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gifmeta.hpp"
+#include "image.hpp"
+#include "palette.hpp"
+#include "stream.hpp"
+
+// Everything about a frame that can be known without decoding its pixels
+struct FrameInfo {
+    size_t      Offset;     // Stream position of the frame's first extension (or its image descriptor)
+    uint16_t    Left;
+    uint16_t    Top;
+    uint16_t    Width;
+    uint16_t    Height;
+    uint16_t    DelayTime;  // Hundredths of a second
+    uint8_t     Disposal;
+    uint8_t     TransparentColorIndex;
+    bool        Transparent;
+    bool        LocalColorTable;
+    const Color* ColorTable;    // Active palette, the local table (stored once per distinct table) or the global one
+    uint16_t    ColorCount;
+};
+
+class FrameIndex
+{
+    public:
+        FrameIndex();
+
+        /**
+         * Walk the block structure of every frame, skipping the image data
+         * by its sub block sizes instead of decoding it
+         *
+         * @param stream - Stream positioned right after the global color table
+         * @param colorTable - Global color table, used by frames without a local one
+         * @param colorCount - Number of colors in the global table
+         * @param palettes - Local color tables are read into it
+         * @return True if the scan reached the trailer
+         */
+        bool Scan(ByteStream* stream, const Color* colorTable, uint16_t colorCount, PaletteSet* palettes);
+
+        /**
+         * Build the table entry of a frame that has already been parsed
+         *
+         * @param img - Image with its extensions and descriptor loaded
+         * @param offset - Stream position the frame started at
+         */
+        static FrameInfo Describe(const Image& img, size_t offset);
+        static FrameInfo Describe(const ImageDescriptor& descriptor, const GraphicsControlExtension& control, size_t offset);
+
+        void Add(const FrameInfo& info);
+        void Clear();
+
+        size_t Count() const { return this->mFrames.size(); }
+        const FrameInfo& operator[](size_t index) const { return this->mFrames[index]; }
+        const std::vector<FrameInfo>& Frames() const { return this->mFrames; }
+
+        // Sum of every frame's delay in milliseconds
+        uint64_t TotalDuration() const { return this->mTotalDuration; }
+
+    private:
+        std::vector<FrameInfo> mFrames;
+        uint64_t mTotalDuration;
+
+    private:
+        void SkipSubBlocks(ByteStream* stream);
+};
+
+#endif // _FRAME_INDEX_HPP
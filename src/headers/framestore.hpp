@@ -0,0 +1,71 @@
+#pragma once
+#ifndef _FRAME_STORE_HPP
+#define _FRAME_STORE_HPP
+
+#include <stddef.h>
+#include <vector>
+#include "canvas.hpp"
+
+// Most frames between two keyframes, even if barely anything changes in between
+#define FRAME_STORE_KEYFRAME_INTERVAL 1024
+
+// Composited frames of a GIF kept as the rectangle that changed since the frame before,
+// full canvases are rebuilt from the closest keyframe when they are asked for. A new keyframe
+// is kept once the rectangles since the last one add up to a whole screen, so rebuilding a
+// frame never copies more than about two screens worth of pixels
+class FrameStore
+{
+    public:
+        /**
+         * @param _keyframeInterval - Most frames between two frames that are kept whole, bounds
+         *                            how many rectangles are applied to rebuild a frame
+         */
+        FrameStore(size_t _keyframeInterval = FRAME_STORE_KEYFRAME_INTERVAL);
+
+        /**
+         * Store the composited screen of the next frame, only the area that differs
+         * from the frame before it is copied
+         *
+         * @return NONE
+         */
+        void Add(const Canvas& screen);
+
+        /**
+         * Rebuild the screen of a frame. Walking forward (like during playback) only applies
+         * the rectangle of each frame on top of the last frame returned
+         *
+         * @param index - Frame number
+         * @return Canvas valid until the next call
+         */
+        const Canvas& Get(size_t index);
+
+        void Clear();
+
+        size_t Count() const { return this->mEntries.size(); }
+
+        // Memory held by the stored pixels
+        size_t Bytes() const { return this->mBytes; }
+
+    private:
+        struct Entry {
+            Rect Area;      // Part of the screen that changed, empty for keyframes and repeated frames
+            Canvas Pixels;  // The screen inside of Area, or the whole screen for keyframes
+        };
+
+        size_t mKeyframeInterval;
+        size_t mBytes;
+        std::vector<Entry> mEntries;
+
+        // Indices of the frames kept whole, in order
+        std::vector<size_t> mKeyframes;
+        size_t mDeltaBytes;     // Pixels stored since the last keyframe
+
+        // Screen of the last frame added, what the next frame is compared against
+        Canvas mLast;
+
+        // Screen of the last frame returned by Get()
+        Canvas mCurrent;
+        size_t mCurrentIndex;
+};
+
+#endif // _FRAME_STORE_HPP
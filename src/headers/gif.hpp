@@ -2,30 +2,114 @@
 #ifndef _GIF_HPP
 #define _GIF_HPP
 
+#include <functional>
+#include <map>
 #include <vector>
+#include <string>
 #include <stdio.h>
+#include "arena.hpp"
+#include "canvas.hpp"
+#include "compositor.hpp"
+#include "framecache.hpp"
+#include "framestore.hpp"
+#include "frameindex.hpp"
 #include "gifmeta.hpp"
 #include "image.hpp"
+#include "palette.hpp"
+#include "stream.hpp"
+
+#define LAZY_DEFAULT_CACHE_SIZE         8
+#define LAZY_DEFAULT_KEYFRAME_INTERVAL  32
+
+// Most keyframes kept, past that every other one is dropped and the interval doubles
+// so memory stays flat however long the animation is
+#define LAZY_MAX_KEYFRAMES              16
+
+// Receives the screen with the first pass of an interlaced frame drawn over it, before the frame is done
+using ProgressHandler = std::function<void(size_t index, const Canvas& screen)>;
 
 class GIF 
 {
     public:
-        FILE* mFile;
+        ByteStream* mStream;
         
         GifHeader mHeader;
         LogicalScreenDescriptor mLsd;
         GlobalColorTableDescriptor mGctd;
-        std::vector<Image> mImageData;
-        Color* mColorTable; // If the flag is present then the gct will be filled
-        std::vector<std::vector<char>> mFrameMap;
+        const Color* mColorTable; // If the flag is present then the gct will be filled, owned by mPalettes
 
     public:
-        GIF(const char* _filepath);
+        GIF(const char* _filepath, StreamBackend _backend = StreamBackend::Mapped);
+
+        /**
+         * Decode a GIF that is already in memory, the buffer must outlive the GIF
+         */
+        GIF(const uint8_t* _data, size_t _size);
+        ~GIF();
+
+        GIF(const GIF&) = delete;
+        GIF& operator=(const GIF&) = delete;
        
         /** 
          * Read each header of the file into their respective members
          */ 
         void Read();
+
+        /**
+         * Read the headers and build the frame table without decoding any pixels,
+         * frame count, delays and disposal methods are available through Index()
+         */
+        void Scan();
+        const FrameIndex& Index() const { return this->mIndex; }
+
+        /**
+         * Decode frames on a pool of threads, a parser thread splits the stream
+         * into frames and the frames are composited in order as they finish.
+         * A single thread decodes everything in order on the calling thread
+         *
+         * @param threads - Number of decode workers
+         */
+        void SetDecodeThreads(unsigned int threads);
+
+        /**
+         * Only index the frames when reading and decode each one when it is asked for.
+         * Composited canvases are kept in an LRU cache and every keyframeInterval'th
+         * canvas is kept so seeking never has to start from the first frame. Long animations
+         * spread at most LAZY_MAX_KEYFRAMES keyframes out over their length
+         *
+         * @param cacheSize - Number of recently used canvases to keep
+         * @param keyframeInterval - Distance between kept canvases
+         */
+        void SetLazy(size_t cacheSize = LAZY_DEFAULT_CACHE_SIZE, size_t keyframeInterval = LAZY_DEFAULT_KEYFRAME_INTERVAL);
+
+        /**
+         * Show interlaced frames before they are decoded: once the coarse first pass (every 8th row)
+         * is in, the screen with it drawn over the previous frame is handed to the handler.
+         * Only frames decoded in order on the calling thread are previewed, that is every frame of an
+         * eager read on a single thread and the frame asked for from GetFrame() in lazy mode
+         *
+         * @param handler - Called on the decoding thread, nullptr turns previews off
+         * @return NONE
+         */
+        void SetProgressive(ProgressHandler handler);
+
+        size_t FrameCount() const;
+
+        /**
+         * Get the composited canvas of a frame, decoding it first in lazy mode
+         * or rebuilding it from the frame store otherwise. The canvas stays valid until the next call
+         *
+         * @param index - Frame number
+         * @return RGB pixel map of the frame
+         */
+        const Canvas& GetFrame(size_t index);
+
+        // Global and local color tables, frames point into it through FrameInfo::ColorTable
+        const PaletteSet& Palettes() const { return this->mPalettes; }
+
+        // Heap allocations made for per frame decode state, recycled by the decoder's arena
+        const ArenaStats& DecodeStats() const { return this->mArena.Stats(); }
+
         static void SigIntHandler(int sig);
 
     private:
@@ -34,11 +118,36 @@ class GIF
         bool mLSDInitialized;
         bool mFrameMapInitialized;
         bool mFrameOutOfBounds;
+        unsigned int mDecodeThreads;
+
+        // Screen the frames are drawn onto in order
+        Compositor mCompositor;
+
+        // Every composited frame when the GIF is read eagerly
+        FrameStore mFrameStore;
 
-        std::vector<char> mPixelMap;
-        std::vector<char> mPrevPixelMap;
+        FrameIndex mIndex;
+        PaletteSet mPalettes;
+
+        // Extension data and raster of the frame being decoded, reused for every frame
+        DecodeArena mArena;
+
+        // Coarse previews of interlaced frames
+        ProgressHandler mProgressive;
+        Canvas mPreviewMap;
+
+        // Lazy decoding, keyframes hold the screen a frame leaves behind once it is disposed of
+        bool mLazy;
+        size_t mKeyframeInterval;
+        std::map<size_t, Canvas> mKeyframes;
+        FrameCache mFrameCache;
+
+        // Last frame drawn by the compositor, decoding carries on from it when it comes before the one asked for
+        long mComposited;
 
     private:
+        void Initialize();
+
         /**
          * Load GIF File header into mHeader
          *
@@ -55,18 +164,44 @@ class GIF
         bool ValidHeader();
 
         /**
-         * Load GIF Logical Screen Descriptor from mFile
+         * Load GIF Logical Screen Descriptor from mStream
          *
          * @return NONE
          */ 
         void LoadLSD();
 
         /**
-         * Generate a pixel map for each frame in mFile
+         * Generate a pixel map for each frame in mStream
          *
          * @return NONE
          */
         void GenerateFrameMap();
+        void GenerateFrameMapParallel();
+
+        void ResetPixelMap();
+
+        // Keep the screen after a frame as a keyframe, thinning out the keyframes once there are too many
+        void AddKeyframe(size_t index);
+
+        // Preview handler for a frame about to be decoded, empty unless previews are on
+        PreviewHandler PreviewFor(Image& img, size_t index);
+
+        // Draw a decoded frame onto the screen
+        void DrawFrame(Image& img, const Canvas& rasterData);
+
+        /**
+         * Draw a decoded frame onto the pixel map and store the result
+         *
+         * @return NONE
+         */
+        void CompositeFrame(Image& img, const Canvas& rasterData);
+
+        /**
+         * Check if the stream is at the trailer (or ran out) and close it if so
+         *
+         * @return True if there are no frames left
+         */
+        bool EndOfFrames();
         
         // Debug Prints
         void PrintHeaderInfo();
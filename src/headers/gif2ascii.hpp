@@ -0,0 +1,158 @@
+#pragma once
+#ifndef _GIF2ASCII_HPP
+#define _GIF2ASCII_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "canvas.hpp"
+#include "frameindex.hpp"
+#include "gif.hpp"
+#include "gifmeta.hpp"
+#include "renderer.hpp"
+#include "scaler.hpp"
+#include "utils/error.hpp"
+#include "utils/logger.hpp"
+
+/*
+    Interface of libgif2ascii for programs that decode and render GIFs in process.
+    Errors are thrown as GifError (utils/error.hpp), nothing in the library exits the process.
+    The library logs nowhere by default, logger.SetHandler() routes its messages into the
+    program's own log
+*/
+
+// A composited frame and when it is shown
+struct FrameView {
+    size_t          Index;
+    const Canvas*   Pixels;             // Whole screen in RGB, valid until the decoder moves to another frame
+    const Color*    ColorTable;         // The frame's own table (local or global), earlier frames left on screen may use others
+    uint16_t        ColorCount;
+    uint32_t        DelayMs;            // How long the frame stays on screen
+    uint64_t        TimestampMs;        // When the frame is shown, counted from the start of a loop
+};
+
+class GifDecoder;
+
+// Walks the frames of a decoder in order, decoding each one when it is first looked at
+class FrameIterator
+{
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = FrameView;
+        using difference_type = ptrdiff_t;
+        using pointer = const FrameView*;
+        using reference = const FrameView&;
+
+        FrameIterator(GifDecoder* _decoder, size_t _index);
+
+        const FrameView& operator*() const;
+        const FrameView* operator->() const { return &**this; }
+        FrameIterator& operator++();
+
+        bool operator==(const FrameIterator& other) const { return this->mIndex == other.mIndex; }
+        bool operator!=(const FrameIterator& other) const { return this->mIndex != other.mIndex; }
+
+    private:
+        GifDecoder* mDecoder;
+        size_t mIndex;
+        mutable FrameView mFrame;
+        mutable bool mLoaded;
+};
+
+// Streams the frames of a GIF, only the frame table is read up front and pixels are decoded on demand
+class GifDecoder
+{
+    public:
+        /**
+         * Open a GIF file and read its frame table
+         *
+         * @param _filepath - Path to the file
+         */
+        GifDecoder(const char* _filepath);
+
+        /**
+         * Read the frame table of a GIF that is already in memory
+         *
+         * @param _data - Whole file, must outlive the decoder
+         * @param _size - Size of the file in bytes
+         */
+        GifDecoder(const uint8_t* _data, size_t _size);
+
+        GifDecoder(const GifDecoder&) = delete;
+        GifDecoder& operator=(const GifDecoder&) = delete;
+
+        uint16_t Width() const { return this->mGIF.mLsd.Width; }
+        uint16_t Height() const { return this->mGIF.mLsd.Height; }
+        size_t FrameCount() const { return this->mGIF.FrameCount(); }
+
+        // Length of one loop in milliseconds
+        uint64_t Duration() const { return this->mGIF.Index().TotalDuration(); }
+
+        // Position, size, delay and disposal of every frame
+        const FrameIndex& Index() const { return this->mGIF.Index(); }
+
+        /**
+         * Decode a frame, going through the frames in order only decodes each one once
+         *
+         * @param index - Frame number, below FrameCount()
+         * @return Composited frame, its pixels stay valid until the next frame is decoded
+         */
+        FrameView Frame(size_t index);
+
+        FrameIterator begin() { return FrameIterator(this, 0); }
+        FrameIterator end() { return FrameIterator(this, FrameCount()); }
+
+    private:
+        GIF mGIF;
+
+        // Start time of every frame
+        std::vector<uint64_t> mTimestamps;
+
+    private:
+        void Initialize();
+};
+
+struct RenderOptions {
+    uint16_t    Columns     = 0;    // Most cells across, 0 keeps the GIF's width
+    uint16_t    Rows        = 0;    // Most rows of cells, 0 keeps the GIF's height
+    float       CellAspect  = DEFAULT_CELL_ASPECT;
+    CellMode    Cells       = CellMode::Glyph;
+    RenderMode  Mode        = RenderMode::Full;
+};
+
+// Turns frames of a decoder into the escape sequences that draw them on a terminal
+class FrameRenderer
+{
+    public:
+        /**
+         * @param _decoder - Decoder the frames come from, sets the size of the picture
+         * @param _options - Output size and style, frames are scaled down to fit keeping their aspect
+         */
+        FrameRenderer(const GifDecoder& _decoder, const RenderOptions& _options = RenderOptions());
+
+        /**
+         * Render a frame into a buffer, replacing what it held and reusing its memory.
+         * Output starts from the top left of the terminal, in delta mode it only redraws
+         * what changed since the last frame rendered
+         *
+         * @param frame - Frame from the decoder given to the constructor
+         * @param output - Receives the escape sequences
+         * @return NONE
+         */
+        void Render(const FrameView& frame, std::string* output);
+
+        // Draw the next frame in full, after the terminal was cleared or frames were skipped
+        void Invalidate();
+
+        // Size of the output in cells
+        uint16_t Columns() const { return this->mScaler.Width(); }
+        uint16_t Rows() const { return this->mRenderer.Rows(); }
+
+    private:
+        Scaler mScaler;
+        Renderer mRenderer;
+};
+
+#endif // _GIF2ASCII_HPP
@@ -12,6 +12,10 @@ constexpr char gif89a[3]        {'8', '9', 'a'};
 #define NULL_COLOR  {0, 0, 0}
 #define COLOR_SIZE  3
 
+// Glyphs from darkest to brightest
+constexpr char CHAR_MAP[] = "$@B%8&WM#*oahkbdpqwmZO0QLCJUYXzcvunxrjft/\\|()1{}[]?-_+~i!lI;:,\"^`\'.";
+constexpr uint16_t CHAR_MAP_SIZE = sizeof(CHAR_MAP) - 1;
+
 enum class LSDMask : uint8_t {
     GlobalColorTable    = 0x07,
     ColorResolution     = 0x04,
@@ -47,12 +51,15 @@ struct GlobalColorTableDescriptor {
 
 struct Color {
     uint8_t Red;
-    uint8_t Blue;
     uint8_t Green;
+    uint8_t Blue;
 
     public:
-        char ToChar();
+        char ToChar() const;
         void Print();
 };
 
+// Color tables are read straight from the file and handed to the kernels as packed RGB
+static_assert(sizeof(Color) == COLOR_SIZE, "Color must be 3 packed bytes");
+
 #endif // _GIF_META_HPP
@@ -2,44 +2,102 @@
 #ifndef _GIF_IMAGE_DATA_HPP
 #define _GIF_IMAGE_DATA_HPP
 
+#include "canvas.hpp"
 #include "imagemeta.hpp"
 #include "gifmeta.hpp"
+#include "stream.hpp"
 #include <stdio.h>
 #include <stdint.h>
+#include <functional>
 #include <string>
 #include <vector>
 
+namespace LZW { class Decoder; }
+class DecodeArena;
+class PaletteSet;
+
+// Interlaced frames are stored in four passes, the first holds every 8th row starting at row 0
+#define INTERLACE_PASSES 4
+
+// Receives the raster of an interlaced frame as soon as its first pass is decoded,
+// every row of the pass is repeated over the 7 rows below it
+using PreviewHandler = std::function<void(const Canvas& preview)>;
+
 class Image 
 {            
     public:
         ImageDescriptor mDescriptor;
         ImageDataHeader mHeader;
         ImageExtensions mExtensions;
-        Color* mColorTable;
-        std::vector<uint8_t> mData;
+
+        // Color table the frame is drawn with, its local one once the descriptor is loaded if it has one
+        const Color* mColorTable;
+        uint16_t mColorTableSize;
 
         bool mTransparent;
         uint8_t mTransparentColorIndex;
         
     public:
-        Image(FILE* _fp, Color* _colortable, uint8_t _colorTableSize);
+        /**
+         * @param _stream - Stream positioned at the frame's first extension (or its image descriptor)
+         * @param _colortable - Global color table of the GIF
+         * @param _colorTableSize - Number of colors in the table
+         * @param _arena - Arena of the decoder, extension data and the decoded raster are kept in it
+         * @param _palettes - Palettes of the GIF, a local color table is stored in it
+         */
+        Image(ByteStream* _stream, const Color* _colortable, uint16_t _colorTableSize, DecodeArena* _arena, PaletteSet* _palettes);
         
-        std::string LoadImageData();
-        void ReadDataSubBlocks();
+        // Read the image descriptor, the local color table (if there is one) and the image data header
+        void LoadDescriptor();
+
+        // Read the descriptor and decode the data sub blocks as they are read,
+        // the raster belongs to the arena and is valid until the next frame is decoded.
+        // Interlaced frames are handed to preview (if set) once their first pass is in
+        const Canvas& LoadImageData(const PreviewHandler& preview = nullptr);
+
+        // Decode the data sub blocks starting at the current position of the stream
+        const Canvas& DecodeImageData(const PreviewHandler& preview = nullptr);
+
+        // Copy the data sub blocks out of the stream so they can be decoded later (on another thread)
+        void ReadCompressedData(std::vector<uint8_t>* data);
+        Canvas DecodeImageData(const std::vector<uint8_t>& data) const;
+
+        void ReadDataSubBlocks(LZW::Decoder& decoder, const Canvas& rasterData, const PreviewHandler& preview = nullptr);
         void CheckExtensions();
 
-        // Return the charstream given after decompression
-        void UpdatePixelMap(std::vector<char>* pixMap, std::vector<char>* prevPixMap, std::string* rasterData, LogicalScreenDescriptor* lsd);
+        bool Interlaced() const { return (this->mDescriptor.Packed >> (uint8_t)ImgDescMask::Interlace) & 0x01; }
+
+        /**
+         * Canvas row a row of an interlaced frame ends up in
+         *
+         * @param streamRow - Position of the row in the data stream
+         * @param height - Height of the frame
+         * @return Row of the canvas
+         */
+        static uint16_t InterlacedRow(uint16_t streamRow, uint16_t height);
 
     private:
-        FILE* mFile;
-        uint8_t mColorTableSize;
+        ByteStream* mStream;
+        DecodeArena* mArena;
+        PaletteSet* mPalettes;
     
     private:
-        // Different Drawing behaviors based off Disposal Methods
-        void DrawOverImage(std::string* rasterData, std::vector<char>* pixelMap, LogicalScreenDescriptor* lsd);
-        void RestoreCanvasToBG(std::vector<char>* pixelMap, LogicalScreenDescriptor* lsd);
-        void RestoreToPrevState(std::vector<char>* pixMap, std::vector<char>* prevPixMap);
+        // Frames are decoded into a canvas without row padding so the decoder can fill it in one go
+        Canvas NewRasterCanvas() const;
+        void CheckDecodedSize(size_t written) const;
+
+        /**
+         * Move the rows of a raster decoded in interlaced order to where they belong, in place.
+         * Every row is moved once by following the cycles of the row order
+         *
+         * @param raster - Raster in stream order
+         * @param scratch - Scratch memory of at least Width() + Height() bytes
+         * @return NONE
+         */
+        static void Deinterlace(Canvas& raster, uint8_t* scratch);
+
+        // Fill the arena's preview canvas from the first pass and hand it to the handler
+        void ShowFirstPass(const Canvas& rasterData, const PreviewHandler& preview);
         
         void LoadExtension(const ExtensionHeader& headerCheck);
         
@@ -9,6 +9,7 @@
 #define EXTENSION_TERMINATOR        0x00
 #define IMAGE_DESCRIPTOR_SEPERATOR  0x2C
 #define TRAILER                     0x3B
+#define APPLICATION_BLOCK_LENGTH    11
 
 enum class ImgDescMask : uint8_t {
     LocalColorTable = 7,
@@ -47,10 +48,6 @@ struct ImageDescriptor {
     uint8_t     Packed;
 } __attribute__((packed));
 
-struct LocalColorTable {
-    // TODO
-} __attribute__((packed));
-
 struct ImageDataHeader {
     uint8_t LZWMinimum;
     uint8_t FollowSize;
@@ -83,6 +80,7 @@ struct GraphicsControlExtension {
     uint8_t         BlockTerminator; // Always 0x00
 } __attribute__((packed));
 
+// Extension data lives in the decoder's arena and is only valid until the next frame is decoded
 struct PlainTextExtension {
     ExtensionHeader Header;
     uint8_t         BlockSize;
@@ -93,14 +91,15 @@ struct PlainTextExtension {
 struct ApplicationExtension {
     ExtensionHeader Header;
     uint8_t         BlockLength;
-    uint8_t*        Identifier;
-    uint8_t*        AuthenticationCode;
+    uint8_t         Identifier[8];
+    uint8_t         AuthenticationCode[3];
     uint8_t         Terminator;
 };
 
 struct CommentExtension {
-    ExtensionHeader         Header;
-    std::vector<uint8_t>    Data; 
+    ExtensionHeader Header;
+    uint8_t*        Data;   // Every sub block of the comment back to back
+    size_t          Size;
 };
 
 struct ImageExtensions {
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef _KERNELS_HPP
+#define _KERNELS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gifmeta.hpp"
+
+// Per pixel conversions, each has a scalar, SSE2 and AVX2 version
+// and the fastest one the CPU supports is picked the first time one is called
+namespace Kernels
+{
+    enum class Level {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Instruction set the kernels currently run with
+    Level Active();
+    const char* Name(Level level);
+
+    /**
+     * Run the kernels with a lower instruction set than the CPU supports (for benchmarks),
+     * asking for one the CPU does not have falls back to the best supported one
+     *
+     * @param level - Highest instruction set to use
+     * @return NONE
+     */
+    void SetLevel(Level level);
+
+    /**
+     * Pack a color table into 32 bit entries (red in the low byte) for ExpandRGB,
+     * indices past the end of the table are black
+     *
+     * @param colorTable - Color table to pack
+     * @param colorCount - Number of colors in the table
+     * @param palette - 256 packed entries
+     * @return NONE
+     */
+    void PackPalette(const Color* colorTable, uint16_t colorCount, uint32_t* palette);
+
+    /**
+     * Look up a row of color indices, writing 3 bytes (red, green, blue) per pixel
+     *
+     * @param indices - Color indices
+     * @param count - Number of pixels
+     * @param palette - 256 entries from PackPalette
+     * @param rgb - Receives count * 3 bytes
+     * @return NONE
+     */
+    void ExpandRGB(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgb);
+
+    /**
+     * Split packed RGB pixels into glyphCount luminance buckets, 0 being the darkest
+     *
+     * @param rgb - count * 3 bytes of red, green, blue
+     * @param count - Number of pixels
+     * @param glyphCount - Number of buckets (at most 256)
+     * @param buckets - Receives a bucket per pixel
+     * @return NONE
+     */
+    void LumaBuckets(const uint8_t* rgb, size_t count, uint16_t glyphCount, uint8_t* buckets);
+
+    // Grayscale brightness (https://en.wikipedia.org/wiki/Grayscale#Converting_color_to_grayscale)
+    // in fixed point, weights are 0.2126, 0.7152 and 0.0722 scaled by 256
+    inline uint8_t Luma(uint8_t red, uint8_t green, uint8_t blue)
+    {
+        return (54 * red + 183 * green + 18 * blue + 128) >> 8;
+    }
+
+    inline uint8_t LumaBucket(uint8_t red, uint8_t green, uint8_t blue, uint16_t glyphCount)
+    {
+        return (Luma(red, green, blue) * glyphCount) >> 8;
+    }
+}
+
+#endif // _KERNELS_HPP
@@ -3,27 +3,84 @@
 #define _LZW_HPP
 
 #include <stdint.h>
-#include <vector>
-#include <unordered_map>
-#include <string>
+#include <stddef.h>
 
 #include "image.hpp"
 #include "gifmeta.hpp"
 
-#define SPECIAL_CODE_COUNT 2
+#define SPECIAL_CODE_COUNT  2
+#define LZW_MAX_CODE_SIZE   12
+#define LZW_TABLE_SIZE      (1 << LZW_MAX_CODE_SIZE)
 
-namespace LZW 
+namespace LZW
 {
-    using namespace std;
-    string Decompress(const ImageDataHeader& imgHeader, const uint8_t colorTableSize, vector<uint8_t> codestream);
+    class Decoder
+    {
+        public:
+            /**
+             * Create a decoder that writes color indices into a caller supplied buffer
+             *
+             * @param minCodeSize - LZW Minimum Code Size read from the image data header
+             * @param output - Buffer receiving the decoded color indices
+             * @param outputSize - Size of the output buffer, anything decoded past it is dropped
+             */
+            Decoder(const uint8_t minCodeSize, uint8_t* output, const size_t outputSize);
+
+            /**
+             * Decode a chunk of the code stream, codes split across chunks
+             * are carried over to the next call
+             *
+             * @param data - Compressed bytes
+             * @param size - Number of bytes in data
+             * @return NONE
+             */
+            void Decode(const uint8_t* data, const size_t size);
+
+            // Number of indices written into the output buffer so far
+            size_t Written() const { return this->mWritten; }
+
+            // True once the End of Information code (or a corrupt code) has been read
+            bool Finished() const { return this->mFinished; }
+
+        private:
+            // Dictionary, each entry is its prefix entry followed by a single suffix index
+            uint16_t mPrefix[LZW_TABLE_SIZE];
+            uint8_t mSuffix[LZW_TABLE_SIZE];
+            uint8_t mFirst[LZW_TABLE_SIZE];
+            uint16_t mLength[LZW_TABLE_SIZE];
+
+            uint8_t* mOutput;
+            size_t mOutputSize;
+            size_t mWritten;
+
+            uint16_t mClearCode;
+            uint16_t mEndCode;
+            uint16_t mNextCode;
+            int mPrevCode;
+            uint8_t mMinCodeSize;
+            uint8_t mCodeSize;
+            uint32_t mCodeMask;
+
+            uint32_t mBitBuffer;
+            uint8_t mBitCount;
+            bool mFinished;
+
+        private:
+            void ResetTable();
+            void Emit(const uint16_t code);
+    };
 
     /**
-     * Initialize a code table based off the size of a given color table
-     * 
-     * @param colorTableSize
-     * @return std::unordered_map<int, std::string> Code Table
+     * Decompress a complete code stream into a caller supplied buffer
+     *
+     * @param imgHeader - Image data header holding the LZW Minimum Code Size
+     * @param codestream - Concatenated sub block data
+     * @param size - Number of bytes in the code stream
+     * @param output - Buffer receiving the decoded color indices
+     * @param outputSize - Size of the output buffer
+     * @return Number of indices written into output
      */
-    unordered_map<int, string> InitializeCodeTable(const uint8_t colorTableSize);
+    size_t Decompress(const ImageDataHeader& imgHeader, const uint8_t* codestream, const size_t size, uint8_t* output, const size_t outputSize);
 }
 
 #endif // _LZW_HPP
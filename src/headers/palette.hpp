@@ -0,0 +1,104 @@
+#pragma once
+#ifndef _PALETTE_HPP
+#define _PALETTE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "gifmeta.hpp"
+
+#define PALETTE_MAX_COLORS 256
+
+// Colors a PaletteCache keeps ready made sequences for
+#define PALETTE_CACHE_BITS  12
+#define PALETTE_CACHE_SLOTS (1 << PALETTE_CACHE_BITS)
+
+// Longest SGR sequence emitted for a single color ("\x1b[38;2;255;255;255m")
+#define SGR_MAX_SIZE 19
+
+struct PaletteEntry {
+    char    Glyph;
+    uint8_t SgrSize;
+    uint8_t ForegroundSize;                 // Length of the foreground part of Sgr
+    char    Sgr[(SGR_MAX_SIZE * 2) + 1];    // Foreground followed by background color
+};
+
+// One copy of every distinct color table of a GIF. Tables are found by their hash, so every frame
+// whose local color table holds the same colors (or repeats the global one) points to the same table
+class PaletteSet
+{
+    public:
+        PaletteSet() {}
+
+        PaletteSet(const PaletteSet&) = delete;
+        PaletteSet& operator=(const PaletteSet&) = delete;
+
+        /**
+         * Find the stored copy of a color table, storing it first if it is new
+         *
+         * @param colors - Color table read from the file
+         * @param count - Number of colors in the table
+         * @return Stored table, valid until Clear()
+         */
+        const Color* Intern(const Color* colors, uint16_t count);
+
+        void Clear();
+
+        // Number of distinct tables
+        size_t Count() const { return this->mTables.size(); }
+
+    private:
+        struct Table {
+            uint16_t Count;
+            std::unique_ptr<Color[]> Colors;
+        };
+
+        // Tables are read on the parser thread while frames are decoded
+        std::mutex mMutex;
+        std::unordered_multimap<uint64_t, Table> mTables;
+
+    private:
+        static uint64_t Hash(const Color* colors, uint16_t count);
+};
+
+// Glyph and escape sequences of the colors drawn lately. The screen holds RGB, so entries are found
+// by their color instead of an index. Frames only draw the colors of a few palettes (and whatever
+// averages of them the scaler makes), so after the first loop next to nothing has to be built again
+class PaletteCache
+{
+    public:
+        PaletteCache();
+
+        /**
+         * Find the entry of a color, building it first if it is not in the cache. An entry stays valid
+         * until the next call, a color landing in the same slot takes its place
+         *
+         * @param color - Packed color, red in the high byte and blue in the low one
+         * @return Glyph and escape sequences of the color
+         */
+        const PaletteEntry& Find(uint32_t color)
+        {
+            uint32_t slot = (color * 2654435761u) >> (32 - PALETTE_CACHE_BITS);
+            if (this->mKeys[slot] != color)
+                Build(slot, color);
+
+            return this->mEntries[slot];
+        }
+
+        // Number of entries built
+        size_t Builds() const { return this->mBuilds; }
+
+    private:
+        // Color held by every slot, an empty slot holds a value no 24 bit color has
+        std::unique_ptr<uint32_t[]> mKeys;
+        std::unique_ptr<PaletteEntry[]> mEntries;
+        size_t mBuilds;
+
+    private:
+        void Build(uint32_t slot, uint32_t color);
+};
+
+#endif // _PALETTE_HPP
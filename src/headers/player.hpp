@@ -0,0 +1,76 @@
+#pragma once
+#ifndef _PLAYER_HPP
+#define _PLAYER_HPP
+
+#include <stddef.h>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include "canvas.hpp"
+#include "gif.hpp"
+#include "utils/ringbuffer.hpp"
+
+#define PLAYER_DEFAULT_DEPTH 8
+
+// How long either side sleeps before checking the ring again when it has to wait
+#define PLAYER_POLL_US 500
+
+struct PlayerFrame {
+    size_t Index;
+    Canvas Pixels;
+};
+
+// Decodes frames on a thread of its own ahead of playback, looping over the GIF forever.
+// Only the frames in the ring are held decoded, so a lazily read GIF plays with bounded memory
+class FramePlayer
+{
+    public:
+        /**
+         * @param _gif - GIF to decode, already read (preferably lazily). Only the player
+         *               may call GetFrame() on it until the player is stopped
+         * @param _depth - Number of decoded frames kept ready
+         */
+        FramePlayer(GIF* _gif, size_t _depth = PLAYER_DEFAULT_DEPTH);
+        ~FramePlayer();
+
+        FramePlayer(const FramePlayer&) = delete;
+        FramePlayer& operator=(const FramePlayer&) = delete;
+
+        /**
+         * Start the decoder thread
+         *
+         * @return NONE
+         */
+        void Start();
+
+        /**
+         * Wait for the next frame in playback order, it stays valid until Release().
+         * An error the decoder thread ran into is thrown here once the frames before it are used up
+         *
+         * @return Decoded frame
+         */
+        const PlayerFrame& Next();
+
+        // Give the frame from Next() back to the decoder
+        void Release();
+
+        // Stop and join the decoder thread
+        void Stop();
+
+        size_t Depth() const { return this->mRing.Capacity(); }
+
+    private:
+        GIF* mGIF;
+        RingBuffer<PlayerFrame> mRing;
+        std::thread mDecoder;
+        std::atomic<bool> mRunning;
+
+        // Set by the decoder thread before it gives up
+        std::exception_ptr mError;
+        std::atomic<bool> mFailed;
+
+    private:
+        void Decode();
+};
+
+#endif // _PLAYER_HPP
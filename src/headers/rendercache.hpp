@@ -0,0 +1,56 @@
+#pragma once
+#ifndef _RENDER_CACHE_HPP
+#define _RENDER_CACHE_HPP
+
+#include <stddef.h>
+#include <vector>
+
+// Fully rendered output of every frame of a looping GIF, so loops after the first one only
+// have to write the bytes out again. A frame's bytes are only right to replay over the frame
+// before it, since in delta mode they only hold the cells that changed since that frame
+class RenderCache
+{
+    public:
+        /**
+         * @param _capacity - Most bytes held before the cache gives up, 0 disables it
+         */
+        RenderCache(size_t _capacity = 0);
+
+        /**
+         * Look up the rendered output of a frame
+         *
+         * @return Bytes of the frame or nullptr if it is not cached
+         */
+        const std::vector<char>* Find(size_t index) const;
+
+        /**
+         * Keep a copy of a frame's rendered output. Going over the capacity throws away
+         * everything and disables the cache, every frame is rendered live from then on
+         *
+         * @return False if the cache is (or just got) disabled
+         */
+        bool Insert(size_t index, const char* data, size_t size);
+
+        void SetCapacity(size_t capacity);
+
+        // Forget every frame, the next pass starts caching again from nothing
+        void Clear();
+
+        bool Enabled() const { return this->mCapacity > 0; }
+
+        // True once the output of frames [0, frameCount) is cached
+        bool Complete(size_t frameCount) const { return Enabled() && this->mCount == frameCount && frameCount > 0; }
+
+        size_t Bytes() const { return this->mBytes; }
+
+    private:
+        size_t mCapacity;
+        size_t mBytes;
+        size_t mCount;
+
+        // Empty (and not counted) until the frame is inserted
+        std::vector<std::vector<char>> mFrames;
+        std::vector<bool> mCached;
+};
+
+#endif // _RENDER_CACHE_HPP
@@ -0,0 +1,141 @@
+#pragma once
+#ifndef _RENDERER_HPP
+#define _RENDERER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "canvas.hpp"
+#include "gifmeta.hpp"
+#include "palette.hpp"
+
+// Escape sequences used to drive the terminal
+constexpr const char* ESC_CURSOR_HOME   {"\x1b[H"};
+constexpr const char* ESC_CLEAR_SCREEN  {"\x1b[2J"};
+constexpr const char* ESC_HIDE_CURSOR   {"\x1b[?25l"};
+constexpr const char* ESC_SHOW_CURSOR   {"\x1b[?25h"};
+constexpr const char* ESC_RESET         {"\x1b[0m"};
+constexpr const char* ESC_DEFAULT_BG    {"\x1b[49m"};
+
+// Upper half block, drawn with the upper pixel as foreground and the lower one as background
+constexpr const char* HALF_BLOCK        {"\u2580"};
+#define HALF_BLOCK_SIZE 3
+
+// Longest cursor position sequence ("\x1b[65536;65536H")
+#define CUP_MAX_SIZE 15
+
+enum class RenderMode {
+    Full,   // Repaint every cell of every frame
+    Delta   // Only repaint the cells that changed since the last frame drawn
+};
+
+enum class CellMode {
+    Glyph,      // One pixel per cell, drawn as a glyph picked by its brightness
+    HalfBlock   // Two pixels stacked in every cell, drawn as a half block
+};
+
+class Renderer
+{
+    public:
+        /**
+         * Create a renderer for frames of a fixed size, the frame buffer
+         * is allocated once here and reused for every frame
+         *
+         * @param _width - Width of a frame in pixels
+         * @param _height - Height of a frame in pixels
+         * @param _mode - Repaint every cell or only the ones that changed
+         * @param _cells - One pixel per cell or two stacked pixels per cell
+         */
+        Renderer(uint16_t _width, uint16_t _height, RenderMode _mode = RenderMode::Full, CellMode _cells = CellMode::Glyph);
+
+        /**
+         * Forget what is on screen so the next frame is drawn in full
+         * (after the terminal was cleared)
+         *
+         * @return NONE
+         */
+        void Invalidate();
+
+        /**
+         * Build a frame into the frame buffer, starting from the top left of the terminal.
+         * In delta mode only runs of changed cells are emitted, each preceded by a cursor move
+         *
+         * @param frame - RGB canvas drawn one pixel per cell (two for half blocks), the renderer's size
+         * @return NONE
+         */
+        void Render(const Canvas& frame);
+
+        /**
+         * Build a frame of cells that were filtered down by a Scaler into the frame buffer,
+         * delta mode works the same as for a canvas
+         *
+         * @param rgb - Packed RGB of every pixel, Width * Height * 3 bytes
+         * @param glyphs - Index into CHAR_MAP of every pixel, not used for half blocks
+         * @return NONE
+         */
+        void Render(const uint8_t* rgb, const uint8_t* glyphs);
+
+        /**
+         * Write the frame buffer to a file descriptor, a whole frame goes out in a single write()
+         * unless the descriptor only accepts part of it
+         *
+         * @param fd - Descriptor to write to
+         * @return True if the whole buffer was written
+         */
+        bool Flush(int fd);
+
+        /**
+         * Hide the cursor and clear the terminal before the first frame,
+         * the next frame is drawn in full
+         *
+         * @param fd - Descriptor of the terminal
+         * @return NONE
+         */
+        void Clear(int fd);
+
+        /**
+         * Write a buffer to a descriptor, retrying on partial writes and interrupts
+         *
+         * @return True if the whole buffer was written
+         */
+        static bool WriteAll(int fd, const char* data, size_t size);
+
+        const char* Data() const { return this->mBuffer.data(); }
+        size_t Size() const { return this->mLength; }
+
+        // Number of terminal rows a frame takes up
+        uint16_t Rows() const { return this->mHeight; }
+
+    private:
+        uint16_t mWidth;
+        uint16_t mHeight;       // In cells, half of the pixel height for half blocks
+        uint16_t mPixelHeight;
+        RenderMode mMode;
+        CellMode mCells;
+
+        std::vector<char> mBuffer;
+        size_t mLength;
+
+        // Glyph and color sequences of the colors drawn lately
+        PaletteCache mPalette;
+
+        // Packed RGB drawn in each cell by the last frame,
+        // for half blocks the upper pixel is kept in the high 32 bits and the lower one in the low 32 bits
+        std::vector<uint64_t> mLastFrame;
+        bool mLastFrameValid;
+
+    private:
+        void Append(const char* str, size_t size);
+        void AppendNumber(unsigned int value);
+        void AppendCursor(int row, int col);
+
+        // Start a frame, returns true if every cell has to be drawn
+        bool BeginFrame();
+        void EndRow(bool full, long* cursor);
+
+        // Rows of pixels are stride bytes apart, glyphs are picked by color if there are none
+        void RenderCells(const uint8_t* rgb, size_t stride, const uint8_t* glyphs);
+        void RenderHalfBlocks(const uint8_t* rgb, size_t stride);
+};
+
+#endif // _RENDERER_HPP
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef _SCALER_HPP
+#define _SCALER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "canvas.hpp"
+#include "gifmeta.hpp"
+
+// Character cells are roughly twice as tall as they are wide
+#define DEFAULT_CELL_ASPECT 2.0f
+
+// Box filters an RGB canvas down into a grid of cells, each cell is the average color of its block of pixels
+class Scaler
+{
+    public:
+        /**
+         * @param _srcWidth - Width of the canvases that are scaled
+         * @param _srcHeight - Height of the canvases that are scaled
+         * @param _dstWidth - Number of output columns, at most _srcWidth
+         * @param _dstHeight - Number of output rows, at most _srcHeight
+         */
+        Scaler(uint16_t _srcWidth, uint16_t _srcHeight, uint16_t _dstWidth, uint16_t _dstHeight);
+
+        /**
+         * Pick the largest output size that fits into a number of cells and keeps the picture's
+         * proportions on cells that are cellAspect times taller than they are wide, never upscaling
+         *
+         * @param srcWidth - Width of the picture
+         * @param srcHeight - Height of the picture
+         * @param maxColumns - Columns available, 0 for no limit
+         * @param maxRows - Rows available, 0 for no limit
+         * @param cellAspect - Height of a character cell divided by its width
+         * @param dstWidth - Receives the number of columns
+         * @param dstHeight - Receives the number of rows
+         * @return NONE
+         */
+        static void Fit(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxColumns, uint16_t maxRows, float cellAspect,
+                        uint16_t* dstWidth, uint16_t* dstHeight);
+
+        // False if the output is the same size as the input and every cell is a single pixel
+        bool Enabled() const { return this->mDstWidth != this->mSrcWidth || this->mDstHeight != this->mSrcHeight; }
+
+        /**
+         * Filter a frame into the cell grid. Only cells covering pixels that changed since the
+         * last call are filtered again
+         *
+         * @param frame - Composited RGB canvas, the size given to the constructor
+         * @return Cells that were filtered again, empty if nothing changed
+         */
+        Rect Scale(const Canvas& frame);
+
+        // Forget the last frame so the next one is filtered in full
+        void Invalidate();
+
+        uint16_t Width() const { return this->mDstWidth; }
+        uint16_t Height() const { return this->mDstHeight; }
+
+        // Packed RGB of every cell (3 bytes each), rows are Width() * 3 bytes
+        const uint8_t* RGB() const { return this->mRGB.data(); }
+
+        // Luminance bucket (index into CHAR_MAP) of every cell
+        const uint8_t* Glyphs() const { return this->mGlyphs.data(); }
+
+    private:
+        uint16_t mSrcWidth;
+        uint16_t mSrcHeight;
+        uint16_t mDstWidth;
+        uint16_t mDstHeight;
+
+        // First source column / row of every output cell, with the end of the last block appended
+        std::vector<uint16_t> mColumnStart;
+        std::vector<uint16_t> mRowStart;
+
+        // Output cell each source column / row falls into
+        std::vector<uint16_t> mColumnCell;
+        std::vector<uint16_t> mRowCell;
+
+        // Canvas of the last frame, used to find what changed
+        Canvas mLastFrame;
+        bool mValid;
+
+        std::vector<uint8_t> mRGB;
+        std::vector<uint8_t> mGlyphs;
+
+        // Running sums of a row of cells, sized for a whole row once so filtering never allocates
+        std::vector<uint32_t> mSums;
+
+    private:
+        void FilterCells(const Canvas& frame, const Rect& cells);
+};
+
+#endif // _SCALER_HPP
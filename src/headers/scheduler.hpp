@@ -0,0 +1,69 @@
+#pragma once
+#ifndef _SCHEDULER_HPP
+#define _SCHEDULER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+// Playback further behind than this (like after the process was stopped) starts over from the
+// current time instead of dropping every frame in between
+#define SCHEDULER_RESYNC_MS 1000
+
+struct PlaybackStats {
+    size_t  FramesShown;
+    size_t  FramesDropped;
+    double  Seconds;        // Time since Start()
+    double  MeanJitterMs;   // Average distance between when a frame was due and when it went out
+    double  MaxJitterMs;
+
+    double Fps() const { return (Seconds > 0) ? FramesShown / Seconds : 0; }
+};
+
+// Paces frames against absolute deadlines on a monotonic clock, so the time spent drawing
+// a frame is taken out of its delay instead of being added on top of it
+class FrameScheduler
+{
+    public:
+        FrameScheduler();
+
+        /**
+         * Start the clock, the first frame is due right away
+         *
+         * @return NONE
+         */
+        void Start();
+
+        /**
+         * Decide whether the next frame should be drawn. A frame whose whole delay has already
+         * passed is dropped, its deadline still counts so the frames after it stay in sync
+         *
+         * @param delayMs - How long the frame stays on screen
+         * @return True if the frame should be drawn, false if it was dropped
+         */
+        bool Begin(uint32_t delayMs);
+
+        /**
+         * Sleep until the frame given to the last Begin() has been on screen for its delay
+         *
+         * @return NONE
+         */
+        void Wait();
+
+        const PlaybackStats& Stats() const;
+
+        // Write the measured rate, jitter and drops to the log
+        void Report() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point mStart;
+        Clock::time_point mFrameDue;    // When the current frame should go out
+        Clock::time_point mFrameEnd;    // When the frame after it is due
+
+        double mJitterTotalMs;
+        mutable PlaybackStats mStats;
+};
+
+#endif // _SCHEDULER_HPP
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef _BYTE_STREAM_HPP
+#define _BYTE_STREAM_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+enum class StreamBackend {
+    Stdio,  // Buffered fread/fseek on the file
+    Mapped, // mmap the whole file and parse with a cursor over the mapping
+    Memory  // Cursor over a caller owned buffer
+};
+
+class ByteStream
+{
+    public:
+        /**
+         * Open a file for reading, mapped streams fall back to stdio
+         * if the file can not be mapped (pipes, empty files, ...)
+         *
+         * @param _filepath - Path of the file to open
+         * @param _backend - Preferred backend, Memory is treated as Mapped
+         */
+        ByteStream(const char* _filepath, StreamBackend _backend = StreamBackend::Mapped);
+
+        /**
+         * Read from a buffer the caller already holds, the buffer must outlive the stream
+         *
+         * @param _data - Start of the buffer
+         * @param _size - Size of the buffer in bytes
+         */
+        ByteStream(const uint8_t* _data, size_t _size);
+        ~ByteStream();
+
+        ByteStream(const ByteStream&) = delete;
+        ByteStream& operator=(const ByteStream&) = delete;
+
+        /**
+         * Copy the next bytes of the stream into dst
+         *
+         * @return Number of bytes copied
+         */
+        size_t Read(void* dst, size_t size);
+
+        /**
+         * Get a pointer to the next bytes of the stream and advance past them.
+         * Mapped and memory streams return a pointer into the buffer itself that
+         * lives as long as the stream, stdio streams copy into a scratch buffer
+         * that is only valid until the next call to View
+         *
+         * @return Pointer to the bytes or nullptr if fewer than size bytes are left
+         */
+        const uint8_t* View(size_t size);
+
+        // Next byte in the stream without advancing, -1 at the end of the stream
+        int Peek();
+        void Skip(size_t size);
+        void Seek(size_t position);
+
+        size_t Tell() const;
+        size_t Size() const { return this->mSize; }
+        bool IsOpen() const { return this->mOpen; }
+        StreamBackend Backend() const { return this->mBackend; }
+
+    private:
+        StreamBackend mBackend;
+        bool mOpen;
+
+        // Stdio backend
+        FILE* mFile;
+        std::vector<uint8_t> mScratch;
+
+        // Mapped and memory backends
+        const uint8_t* mData;
+        size_t mPos;
+        size_t mSize;
+
+    private:
+        bool Map(const char* _filepath);
+        bool OpenFile(const char* _filepath);
+};
+
+#endif // _BYTE_STREAM_HPP
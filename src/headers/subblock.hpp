@@ -0,0 +1,45 @@
+#pragma once
+#ifndef _SUB_BLOCK_HPP
+#define _SUB_BLOCK_HPP
+
+#include <stdint.h>
+#include "stream.hpp"
+
+#define SUB_BLOCK_MAX_SIZE 255
+
+class SubBlockReader
+{
+    public:
+        /**
+         * Stream the data sub blocks of an image one block at a time
+         *
+         * @param _stream - Stream positioned at the first byte of the first sub block's data
+         * @param _firstSize - Size of the first sub block (already read with the image data header)
+         */
+        SubBlockReader(ByteStream* _stream, uint8_t _firstSize);
+
+        /**
+         * Advance to the next sub block, its data is available through Data()
+         * until the next call (see ByteStream::View)
+         *
+         * @return Number of bytes in the block, 0 once the block terminator has been reached
+         */
+        uint8_t Next();
+
+        /**
+         * Skip every remaining sub block up to and including the block terminator
+         *
+         * @return NONE
+         */
+        void Skip();
+
+        const uint8_t* Data() const { return this->mData; }
+
+    private:
+        ByteStream* mStream;
+        const uint8_t* mData; // Block data followed by the next block's size
+        uint8_t mNextSize;
+        bool mTerminated;
+};
+
+#endif // _SUB_BLOCK_HPP
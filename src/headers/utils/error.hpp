@@ -6,7 +6,9 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include "utils/logger.hpp"
 #define OPT [[maybe_unused]]
 
@@ -16,17 +18,42 @@ enum class Severity {
     high
 };
 
-inline void error(Severity severity)
+// Thrown by error(), the executable exits with the severity as its status
+class GifError : public std::runtime_error
 {
-    logger.Log(ERROR, "Exiting with severity: %d", (int)severity);
-    std::exit((int)severity);
-}
+    public:
+        GifError(Severity _severity, const std::string& _message)
+            : std::runtime_error(_message)
+        {
+            mSeverity = _severity;
+        }
+
+        Severity Level() const { return mSeverity; }
+
+    private:
+        Severity mSeverity;
+};
 
-template<typename T, typename... Ts>
-inline constexpr void error(Severity severity, T head, Ts... tail)
+/**
+ * Log an error made of every part separated by spaces and throw it as a GifError,
+ * nothing in the decoder ends the process so it can be used from other programs
+ *
+ * @param severity - How bad the error is
+ * @param parts - Pieces of the message
+ * @return NONE
+ */
+template<typename... Ts>
+[[noreturn]] inline void error(Severity severity, Ts... parts)
 {
-    logger.Log(ERROR, "%s ", head);
-    error(severity, tail...);
+    std::ostringstream message;
+    ((message << parts << ' '), ...);
+
+    std::string text = message.str();
+    if (!text.empty())
+        text.pop_back();
+
+    logger.Log(ERROR, "%s", text.c_str());
+    throw GifError(severity, text);
 }
 
 #endif // _ERROR_HPP_
@@ -10,10 +10,11 @@
 #include <string>
 #include <string_view>
 #include <chrono>
+#include <functional>
+#include <mutex>
+#include <time.h>
 #include "utils/strutils.hpp"
 
-class Logger;
-extern Logger logger;
 constexpr const char* COLOR_TRACE           {"\033[1;30m"};
 constexpr const char* COLOR_SUCCESS         {"\033[1;32m"};
 constexpr const char* COLOR_DEBUG           {"\033[1;37m"};
@@ -40,10 +41,25 @@ class Logger
         {
             mFilename = ""; 
             mConsoleOutEnabled = enableConsoleOut; 
+            mCurrentLevel = ERROR;
+            mTracingEnabled = false;
+            mHandler = nullptr;
         }
 
-        Logger(std::string path, std::string filename, bool enableConsoleOut = true) {
+        Logger(std::string path, std::string filename, bool enableConsoleOut = true)
+            : Logger(enableConsoleOut)
+        {
+            Open(path, filename);
+        }
+
+        // Every call locks the logger so it can be shared between threads
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        void Open(std::string path, std::string filename)
+        {
             if (!path.empty() && !filename.empty()) {
+                std::lock_guard<std::mutex> lock(mMutex);
                 mFilename = std::string(path) + std::string(filename) + ".log";
                 mStream.open(mFilename);
 
@@ -52,18 +68,19 @@ class Logger
                 mStream.write((char*)bom, sizeof(bom));
             }
 
-            mConsoleOutEnabled = enableConsoleOut;
             Log(SUCCESS, "Initialized Logger");        
         }
 
         void Close()
         {
+            std::lock_guard<std::mutex> lock(mMutex);
             if (mStream.is_open())
                 mStream.close();
         }
 
         template<typename T> Logger& operator<<(T t)
         {
+            std::lock_guard<std::mutex> lock(mMutex);
             if (mStream.is_open())
                 mStream << t;
             
@@ -72,6 +89,7 @@ class Logger
 
         Logger& operator<<(std::ostream& (*func) (std::ostream&))
         {
+            std::lock_guard<std::mutex> lock(mMutex);
             if (mStream.is_open())
                 mStream << std::endl;
     
@@ -82,8 +100,12 @@ class Logger
         {
             std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
             
+            // localtime() shares one buffer between every thread
+            std::tm local = {};
+            localtime_r(&now, &local);
+
             std::string dateTimeStr(25, '\0');
-            std::strftime(&dateTimeStr[0], dateTimeStr.size(), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+            std::strftime(&dateTimeStr[0], dateTimeStr.size(), "%Y-%m-%d %H:%M:%S", &local);
 
             // Strip all null characters
             for (int i = 24; dateTimeStr[i] == '\0'; i--) {
@@ -129,12 +151,19 @@ class Logger
             std::string msg = strFormat(fmt, args);
             va_end(args);
             
+            // Lines from different threads are written whole, never interleaved
+            std::lock_guard<std::mutex> lock(mMutex);
             if (mStream.is_open())
                 mStream << prefix(level) << msg << std::endl;
 
-            fprintf((level < LogLevel::ERROR) ? stdout : stderr,
-                "%s| %s%s\n",
-                LevelColor(level), COLOR_RESET, msg.c_str());
+            if (mConsoleOutEnabled) {
+                fprintf((level < LogLevel::ERROR) ? stdout : stderr,
+                    "%s| %s%s\n",
+                    LevelColor(level), COLOR_RESET, msg.c_str());
+            }
+
+            if (mHandler)
+                mHandler(level, msg);
         }
 
         void SetLevel(LogLevel level) {
@@ -145,12 +174,24 @@ class Logger
             mTracingEnabled = true;
         }
 
+        // Keep logging to the file (if one is open) without printing to the console
+        void SetConsoleOut(bool enabled) {
+            mConsoleOutEnabled = enabled;
+        }
+
+        // Hand every message to a function as well (a program embedding the decoder routing
+        // messages into its own log), called with the logger locked. Set before any logging starts
+        void SetHandler(std::function<void(LogLevel, const std::string&)> handler) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mHandler = std::move(handler);
+        }
+
         auto ShouldLog(LogLevel level) const -> bool 
         {
             if (!mTracingEnabled && level == LogLevel::TRACE) 
                 return false;
 
-            return (mConsoleOutEnabled) && (mCurrentLevel <= level);
+            return (mConsoleOutEnabled || mStream.is_open() || mHandler) && (mCurrentLevel <= level);
         }
 
         inline auto LevelColor(LogLevel level) -> const char* 
@@ -182,9 +223,15 @@ class Logger
     private:
         std::string mFilename;
         std::ofstream mStream;
+        std::mutex mMutex;
         LogLevel mCurrentLevel;
         bool mTracingEnabled;
         bool mConsoleOutEnabled;
+        std::function<void(LogLevel, const std::string&)> mHandler;
 };
 
+// Shared by everything in the decoder, silent until a program opens a file,
+// turns on the console or sets a handler so embedding the library prints nothing
+inline Logger logger(false);
+
 #endif // _LOGGER_HPP_
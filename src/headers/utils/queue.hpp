@@ -0,0 +1,65 @@
+#pragma once
+#ifndef _BOUNDED_QUEUE_HPP_
+#define _BOUNDED_QUEUE_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO shared between threads, producers wait while it is full
+template<typename T>
+class BoundedQueue
+{
+    public:
+        BoundedQueue(size_t capacity)
+        {
+            mCapacity = (capacity == 0) ? 1 : capacity;
+            mClosed = false;
+        }
+
+        void Push(T item)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mNotFull.wait(lock, [this] { return mItems.size() < mCapacity; });
+
+            mItems.push_back(std::move(item));
+            mNotEmpty.notify_one();
+        }
+
+        /**
+         * Wait for the next item
+         *
+         * @return False once the queue is closed and empty
+         */
+        bool Pop(T& item)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mNotEmpty.wait(lock, [this] { return mClosed || !mItems.empty(); });
+
+            if (mItems.empty())
+                return false;
+
+            item = std::move(mItems.front());
+            mItems.pop_front();
+            mNotFull.notify_one();
+            return true;
+        }
+
+        // No more items will be pushed, Pop drains what is left and then returns false
+        void Close()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mClosed = true;
+            mNotEmpty.notify_all();
+        }
+
+    private:
+        std::deque<T> mItems;
+        size_t mCapacity;
+        bool mClosed;
+        std::mutex mMutex;
+        std::condition_variable mNotEmpty;
+        std::condition_variable mNotFull;
+};
+
+#endif // _BOUNDED_QUEUE_HPP_
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef _RING_BUFFER_HPP_
+#define _RING_BUFFER_HPP_
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+// Keeps the producer's and the consumer's counters on their own cache lines
+#define RING_CACHE_LINE 64
+
+// Lock free FIFO between exactly one producer thread and one consumer thread.
+// Slots are allocated once and written in place, so items with buffers of their own
+// (like canvases) keep reusing them instead of being moved in and out
+template<typename T>
+class RingBuffer
+{
+    public:
+        RingBuffer(size_t capacity)
+            : mSlots((capacity == 0) ? 1 : capacity)
+        {
+            mHead.store(0, std::memory_order_relaxed);
+            mTail.store(0, std::memory_order_relaxed);
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        /**
+         * Producer side, get the slot the next item is written into
+         *
+         * @return Free slot or nullptr if the ring is full
+         */
+        T* WriteSlot()
+        {
+            size_t tail = mTail.load(std::memory_order_relaxed);
+            if (tail - mHead.load(std::memory_order_acquire) == mSlots.size())
+                return nullptr;
+
+            return &mSlots[tail % mSlots.size()];
+        }
+
+        // Producer side, hand the slot from WriteSlot() over to the consumer
+        void Push()
+        {
+            mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * Consumer side, get the oldest item without removing it
+         *
+         * @return Oldest item or nullptr if the ring is empty
+         */
+        T* ReadSlot()
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            if (head == mTail.load(std::memory_order_acquire))
+                return nullptr;
+
+            return &mSlots[head % mSlots.size()];
+        }
+
+        // Consumer side, give the slot from ReadSlot() back to the producer
+        void Pop()
+        {
+            mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        size_t Capacity() const { return mSlots.size(); }
+
+    private:
+        std::vector<T> mSlots;
+
+        // Number of items ever popped / pushed, only ever written by the consumer / producer
+        alignas(RING_CACHE_LINE) std::atomic<size_t> mHead;
+        alignas(RING_CACHE_LINE) std::atomic<size_t> mTail;
+};
+
+#endif // _RING_BUFFER_HPP_
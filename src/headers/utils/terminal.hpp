@@ -0,0 +1,31 @@
+#pragma once
+#ifndef _TERMINAL_HPP_
+#define _TERMINAL_HPP_
+
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/**
+ * Ask the terminal behind a descriptor how many character cells it has
+ *
+ * @param fd - Descriptor of the terminal
+ * @param columns - Receives the number of columns
+ * @param rows - Receives the number of rows
+ * @return False if the descriptor is not a terminal (or the size is unknown)
+ */
+inline bool TerminalSize(int fd, uint16_t* columns, uint16_t* rows)
+{
+    struct winsize size = {};
+    if (!isatty(fd) || ioctl(fd, TIOCGWINSZ, &size) < 0)
+        return false;
+
+    if (size.ws_col == 0 || size.ws_row == 0)
+        return false;
+
+    *columns = size.ws_col;
+    *rows = size.ws_row;
+    return true;
+}
+
+#endif // _TERMINAL_HPP_
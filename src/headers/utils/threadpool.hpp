@@ -0,0 +1,105 @@
+#pragma once
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+    public:
+        ThreadPool(size_t threads)
+        {
+            mStopping = false;
+
+            if (threads == 0)
+                threads = 1;
+
+            for (size_t i = 0; i < threads; i++)
+                mWorkers.emplace_back([this] { WorkerLoop(); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mStopping = true;
+            }
+
+            mCondition.notify_all();
+            for (std::thread& worker : mWorkers)
+                worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * Queue a task to run on the next free worker
+         *
+         * @return Future holding the result of the task
+         */
+        template<typename F>
+        auto Submit(F&& task) -> std::future<decltype(task())>
+        {
+            using Result = decltype(task());
+
+            // packaged_task is move only so it is shared to fit inside of a std::function
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> result = packaged->get_future();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTasks.emplace([packaged] { (*packaged)(); });
+            }
+
+            mCondition.notify_one();
+            return result;
+        }
+
+        size_t Size() const { return mWorkers.size(); }
+
+        // Number of threads to use when the caller does not ask for a specific amount
+        static size_t DefaultThreadCount()
+        {
+            unsigned int count = std::thread::hardware_concurrency();
+            return (count == 0) ? 1 : count;
+        }
+
+    private:
+        std::vector<std::thread> mWorkers;
+        std::queue<std::function<void()>> mTasks;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mStopping;
+
+    private:
+        void WorkerLoop()
+        {
+            while (true) {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+
+                    // Finish whatever is still queued before shutting down
+                    if (mStopping && mTasks.empty())
+                        return;
+
+                    task = std::move(mTasks.front());
+                    mTasks.pop();
+                }
+
+                task();
+            }
+        }
+};
+
+#endif // _THREAD_POOL_HPP_
@@ -1,102 +1,208 @@
 #include "image.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <stdio.h>
-#include <unordered_map>
+#include <string.h>
+#include "arena.hpp"
 #include "lzw.hpp"
+#include "palette.hpp"
+#include "subblock.hpp"
 #include "utils/logger.hpp"
 #include "utils/error.hpp"
 
-Image::Image(FILE* _fp, Color* _colortable, uint8_t _colorTableSize)
+// First row and distance between rows of every interlace pass
+static const uint8_t INTERLACE_START[INTERLACE_PASSES] = {0, 4, 2, 1};
+static const uint8_t INTERLACE_STEP[INTERLACE_PASSES] = {8, 8, 4, 2};
+
+// Number of rows a pass holds in a frame of the given height
+static uint16_t PassRows(int pass, uint16_t height)
 {
-    this->mFile = _fp;
+    uint16_t start = INTERLACE_START[pass];
+    uint16_t step = INTERLACE_STEP[pass];
+    return (height > start) ? (height - start + step - 1) / step : 0;
+}
+
+Image::Image(ByteStream* _stream, const Color* _colortable, uint16_t _colorTableSize, DecodeArena* _arena, PaletteSet* _palettes)
+{
+    this->mStream = _stream;
+    this->mArena = _arena;
+    this->mPalettes = _palettes;
     this->mColorTable = _colortable;
     this->mColorTableSize = _colorTableSize;
 
     this->mDescriptor = {};
     this->mHeader = {};
     this->mExtensions = {};
-    this->mData = std::vector<uint8_t>();
 }
 
-std::string Image::LoadImageData()
+void Image::LoadDescriptor()
 {
-    logger.Log(TRACE, "Loading image data");
-
     // Load the Image Descriptor into memory
-    fread(&this->mDescriptor, sizeof(uint8_t), sizeof(ImageDescriptor), this->mFile);
+    this->mStream->Read(&this->mDescriptor, sizeof(ImageDescriptor));
 
-    // TODO:
-    //Add support for LCT in GIFS that require it
-    if ((this->mDescriptor.Packed >> (uint8_t)ImgDescMask::LocalColorTable) & 0x1)
+    // The local color table sits between the descriptor and the image data and replaces the global one for this frame
+    if ((this->mDescriptor.Packed >> (uint8_t)ImgDescMask::LocalColorTable) & 0x1) {
         logger.Log(DEBUG, "Loading Local Color Table");
-    else
+
+        uint16_t count = 2 << ((this->mDescriptor.Packed >> (uint8_t)ImgDescMask::IMGSize) & 0x07);
+        Color colors[PALETTE_MAX_COLORS] = {};
+        this->mStream->Read(colors, count * COLOR_SIZE);
+
+        this->mColorTable = this->mPalettes->Intern(colors, count);
+        this->mColorTableSize = count;
+    } else {
         logger.Log(DEBUG, "Local Color Table flag not set");
+    }
 
     // Load the image header into memory
-    fread(&this->mHeader, sizeof(uint8_t), sizeof(ImageDataHeader), this->mFile); // Only read 2 bytes of file steam for LZW min and Follow Size 
-    ReadDataSubBlocks();
+    this->mStream->Read(&this->mHeader, sizeof(ImageDataHeader)); // Only read 2 bytes of file steam for LZW min and Follow Size 
+}
+
+const Canvas& Image::LoadImageData(const PreviewHandler& preview)
+{
+    logger.Log(TRACE, "Loading image data");
+    LoadDescriptor();
+
+    return DecodeImageData(preview);
+}
+
+const Canvas& Image::DecodeImageData(const PreviewHandler& preview)
+{
+    // Get the raster data from the image frame by decompressing the data sub blocks as they are read,
+    // the decoder writes straight into the raster canvas so it is sized for the whole frame up front
+    Canvas& rasterData = this->mArena->Raster(this->mDescriptor.Width, this->mDescriptor.Height);
+    LZW::Decoder decoder(this->mHeader.LZWMinimum, rasterData.Data(), rasterData.Stride() * rasterData.Height());
+    ReadDataSubBlocks(decoder, rasterData, preview);
+    CheckDecodedSize(decoder.Written());
+
+    if (Interlaced())
+        Deinterlace(rasterData, this->mArena->Allocate((size_t)rasterData.Width() + rasterData.Height()));
 
-    // Get the raster data from the image frame by decompressing the data block from the gif
-    std::string rasterData = LZW::Decompress(this->mHeader, this->mColorTableSize, this->mData);
     return rasterData;
 }
 
-void Image::ReadDataSubBlocks()
+void Image::ReadCompressedData(std::vector<uint8_t>* data)
 {
-    logger.Log(TRACE, "Reading data subblocks");
+    logger.Log(TRACE, "Reading compressed data");
 
-    uint8_t nextByte = 0;
-    int followSize = this->mHeader.FollowSize;
-    
-    while (followSize--) {
-        fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
-        this->mData.push_back(nextByte);
+    SubBlockReader reader = SubBlockReader(this->mStream, this->mHeader.FollowSize);
+
+    uint8_t size = 0;
+    while ((size = reader.Next()) > 0)
+        data->insert(data->end(), reader.Data(), reader.Data() + size);
+}
+
+Canvas Image::DecodeImageData(const std::vector<uint8_t>& data) const
+{
+    Canvas rasterData = NewRasterCanvas();
+    size_t written = LZW::Decompress(this->mHeader, data.data(), data.size(), rasterData.Data(), rasterData.Stride() * rasterData.Height());
+    CheckDecodedSize(written);
+
+    if (Interlaced()) {
+        std::vector<uint8_t> scratch((size_t)rasterData.Width() + rasterData.Height());
+        Deinterlace(rasterData, scratch.data());
     }
 
-    fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
+    return rasterData;
+}
 
-    while (true) {
-        // Check for the end of sub block
-        if (!nextByte)
-            break;
-        
-        followSize = nextByte;
-        while (followSize--) {
-            fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
-            this->mData.push_back(nextByte);
+Canvas Image::NewRasterCanvas() const
+{
+    return Canvas(this->mDescriptor.Width, this->mDescriptor.Height, 0, this->mDescriptor.Width);
+}
+
+void Image::CheckDecodedSize(size_t written) const
+{
+    // Pixels missing from a truncated stream are left at index 0
+    size_t expected = (size_t)this->mDescriptor.Width * this->mDescriptor.Height;
+    if (written < expected)
+        logger.Log(WARNING, "Image: Decoded %d of %d pixels", (int)written, (int)expected);
+}
+
+void Image::ReadDataSubBlocks(LZW::Decoder& decoder, const Canvas& rasterData, const PreviewHandler& preview)
+{
+    logger.Log(TRACE, "Reading data subblocks");
+
+    SubBlockReader reader = SubBlockReader(this->mStream, this->mHeader.FollowSize);
+
+    // The first pass is at the start of the stream, so it is complete long before the frame is
+    size_t firstPass = (preview && Interlaced()) ? (size_t)PassRows(0, rasterData.Height()) * rasterData.Width() : 0;
+
+    uint8_t size = 0;
+    while (!decoder.Finished() && (size = reader.Next()) > 0) {
+        decoder.Decode(reader.Data(), size);
+
+        if (firstPass > 0 && decoder.Written() >= firstPass) {
+            ShowFirstPass(rasterData, preview);
+            firstPass = 0;
         }
+    }
+
+    // Anything after the End of Information code is padding
+    reader.Skip();
+}
+
+uint16_t Image::InterlacedRow(uint16_t streamRow, uint16_t height)
+{
+    for (int pass = 0; pass < INTERLACE_PASSES; pass++) {
+        uint16_t rows = PassRows(pass, height);
+        if (streamRow < rows)
+            return INTERLACE_START[pass] + (streamRow * INTERLACE_STEP[pass]);
 
-        fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
+        streamRow -= rows;
     }
 
-    // Print out the compressed stream of data 
-    for (uint8_t d : this->mData) {
-        fprintf(stdout, "%X ", d);
+    return streamRow;
+}
+
+void Image::Deinterlace(Canvas& raster, uint8_t* scratch)
+{
+    uint16_t width = raster.Width();
+    uint16_t height = raster.Height();
+
+    // Row being carried, followed by a flag for every row already holding its final contents
+    uint8_t* row = scratch;
+    uint8_t* placed = scratch + width;
+    memset(placed, 0, height);
+
+    for (uint16_t start = 0; start < height; start++) {
+        if (placed[start])
+            continue;
+
+        // Carry a row along its cycle, swapping it into the place it belongs and picking up the row that was there
+        memcpy(row, raster.Row(start), width);
+        uint16_t target = InterlacedRow(start, height);
+        while (!placed[target]) {
+            std::swap_ranges(row, row + width, raster.Row(target));
+            placed[target] = true;
+            target = InterlacedRow(target, height);
+        }
     }
+}
+
+void Image::ShowFirstPass(const Canvas& rasterData, const PreviewHandler& preview)
+{
+    // Each row of the first pass stands in for itself and the 7 rows below it
+    Canvas& coarse = this->mArena->Preview(rasterData.Width(), rasterData.Height());
+    for (uint16_t row = 0; row < rasterData.Height(); row++)
+        memcpy(coarse.Row(row), rasterData.Row(row / INTERLACE_STEP[0]), rasterData.Width());
 
-    // Debug::Print("\n");
+    logger.Log(TRACE, "Showing first pass of an interlaced frame");
+    preview(coarse);
 }
 
 void Image::CheckExtensions()
 {
     logger.Log(TRACE, "Checking for extensions");
 
-    // Load a dummy header into memory
     // Allocate space in memory for an extension header
     ExtensionHeader extensionCheck = {};
 
     // Continue to loop until the next byte is not an extension introducer
-    while (true) {
-        fread(&extensionCheck, sizeof(uint8_t), sizeof(ExtensionHeader), this->mFile);
-
-        // If the dummy header contains an introducer for a extension, load the extension type
-        if (extensionCheck.Introducer == EXTENSION_INTRODUCER) {
-            LoadExtension(extensionCheck);
-        } else {
-            fseek(this->mFile, -2, SEEK_CUR);
-            return;
-        }
+    while (this->mStream->Peek() == EXTENSION_INTRODUCER) {
+        this->mStream->Read(&extensionCheck, sizeof(ExtensionHeader));
+        LoadExtension(extensionCheck);
     }
 }
 
@@ -104,9 +210,9 @@ void Image::LoadExtension(const ExtensionHeader& headerCheck)
 {
     logger.Log(TRACE, "Load Extensions");
 
-    // If the header has a valid label for an extension, start each one
-    // by loading the struct into memory and set its header to the one that was passed in
-    fseek(this->mFile, -2, SEEK_CUR);
+    // The header has already been read from the stream, each extension
+    // copies it in and continues reading from the byte following the label
+    uint8_t nextSize = 0;
 
     switch (headerCheck.Label) {
         case ExtensionLabel::PlainText:
@@ -115,13 +221,17 @@ void Image::LoadExtension(const ExtensionHeader& headerCheck)
 
             // Load Header
             this->mExtensions.PlainText = {};
-            fread(&this->mExtensions.PlainText.Header, sizeof(uint8_t), sizeof(ExtensionHeader), this->mFile);
+            this->mExtensions.PlainText.Header = headerCheck;
 
             // Load the block size into the struct and load the data of that size into the data buffer
-            fread(&this->mExtensions.PlainText.BlockSize, sizeof(uint8_t), 1, this->mFile);
+            this->mStream->Read(&this->mExtensions.PlainText.BlockSize, sizeof(uint8_t));
+
+            this->mExtensions.PlainText.Data = this->mArena->Allocate(this->mExtensions.PlainText.BlockSize);
+            this->mStream->Read(this->mExtensions.PlainText.Data, this->mExtensions.PlainText.BlockSize);
 
-            this->mExtensions.PlainText.Data = new uint8_t[this->mExtensions.PlainText.BlockSize];
-            fread(&this->mExtensions.PlainText.Data, sizeof(uint8_t), this->mExtensions.PlainText.BlockSize, this->mFile);
+            // The text itself follows as data sub blocks
+            this->mStream->Read(&nextSize, sizeof(uint8_t));
+            SubBlockReader(this->mStream, nextSize).Skip();
 
             logger.Log(DEBUG, "End of plain text extension");
             break;
@@ -130,9 +240,10 @@ void Image::LoadExtension(const ExtensionHeader& headerCheck)
         {
             logger.Log(DEBUG, "Loading graphics control extension");
 
-            // Load The entire Graphic Control Extension
+            // Load The rest of the Graphic Control Extension
             this->mExtensions.GraphicsControl = {};
-            fread(&this->mExtensions.GraphicsControl, sizeof(uint8_t), sizeof(GraphicsControlExtension), this->mFile);
+            this->mExtensions.GraphicsControl.Header = headerCheck;
+            this->mStream->Read(&this->mExtensions.GraphicsControl.BlockSize, sizeof(GraphicsControlExtension) - sizeof(ExtensionHeader));
             
             // Check for transparency
             if ((this->mExtensions.GraphicsControl.Packed >> (uint8_t)GCEMask::TransparentColor) & 0x01) {
@@ -154,13 +265,25 @@ void Image::LoadExtension(const ExtensionHeader& headerCheck)
 
             // Load Header
             this->mExtensions.Comment = {};
-            fread(&this->mExtensions.Comment.Header, sizeof(uint8_t), sizeof(ExtensionHeader), this->mFile);
+            this->mExtensions.Comment.Header = headerCheck;
 
-            // Read into the data section until a null terminator is hit
-            uint8_t nextByte = 0;
-            for (int i = 0; nextByte != 0x00; i++) {
-                fread(&nextByte, sizeof(uint8_t), 1, this->mFile);
-                this->mExtensions.Comment.Data.push_back(nextByte);
+            // The sub blocks are walked once to size the comment and again to copy it into the arena
+            this->mStream->Read(&nextSize, sizeof(uint8_t));
+            size_t start = this->mStream->Tell();
+
+            SubBlockReader reader = SubBlockReader(this->mStream, nextSize);
+            uint8_t size = 0;
+            while ((size = reader.Next()) > 0)
+                this->mExtensions.Comment.Size += size;
+
+            this->mStream->Seek(start);
+            this->mExtensions.Comment.Data = this->mArena->Allocate(this->mExtensions.Comment.Size);
+
+            size_t offset = 0;
+            reader = SubBlockReader(this->mStream, nextSize);
+            while ((size = reader.Next()) > 0) {
+                memcpy(this->mExtensions.Comment.Data + offset, reader.Data(), size);
+                offset += size;
             }
 
             logger.Log(DEBUG, "End of comment extension");
@@ -172,102 +295,37 @@ void Image::LoadExtension(const ExtensionHeader& headerCheck)
 
             // Load Header
             this->mExtensions.Application = {};
-            fread(&this->mExtensions.Application.Header, sizeof(uint8_t), sizeof(ExtensionHeader), this->mFile);
+            this->mExtensions.Application.Header = headerCheck;
 
             // Load the Block Length
-            fread(&this->mExtensions.Application.BlockLength, sizeof(uint8_t), 1, this->mFile);
+            this->mStream->Read(&this->mExtensions.Application.BlockLength, sizeof(uint8_t));
 
-            // Load Application Identifier
-            fread(&this->mExtensions.Application.Identifier, sizeof(uint8_t), this->mExtensions.Application.BlockLength, this->mFile);
-            
-            // Load the authentication code
-            uint8_t tmp = 0;
-            fread(&tmp, sizeof(uint8_t), 1, this->mFile);
-            fread(&this->mExtensions.Application.AuthenticationCode, sizeof(uint8_t), tmp, this->mFile);
+            // Load Application Identifier and the authentication code
+            const uint8_t* block = this->mStream->View(this->mExtensions.Application.BlockLength);
+            if (block != nullptr && this->mExtensions.Application.BlockLength >= APPLICATION_BLOCK_LENGTH) {
+                memcpy(this->mExtensions.Application.Identifier, block, sizeof(ApplicationExtension::Identifier));
+                memcpy(this->mExtensions.Application.AuthenticationCode, block + sizeof(ApplicationExtension::Identifier), sizeof(ApplicationExtension::AuthenticationCode));
+            }
 
-            // Check if the next byte in the file is the terminator
-            fread(&tmp, sizeof(uint8_t), 1, this->mFile);
-            if (!tmp)
-                logger.Log(DEBUG, "End of application extension");
+            // Skip the application data, nothing in it is used for drawing
+            this->mStream->Read(&nextSize, sizeof(uint8_t));
+            SubBlockReader(this->mStream, nextSize).Skip();
 
+            logger.Log(DEBUG, "End of application extension");
             break;
         }
         default:
         {
-            logger.Log(DEBUG, "Recived invalid extension type [");
-            fseek(this->mFile, 2, SEEK_CUR); // Restore the file position to where it was after reading header
-            break;
-        }
-    }
-}
+            logger.Log(DEBUG, "Recived invalid extension type [%X]", (uint8_t)headerCheck.Label);
 
-void Image::UpdatePixelMap(std::vector<char>* pixMap, std::vector<char>* prevPixMap, std::string* rasterData, LogicalScreenDescriptor* lsd)
-{
-    logger.Log(TRACE, "Updating pixel map");
-
-    // Because each gif can have a different disposal method for different frames (according to GIF89a)
-    // it is best to handle each disposal method instread of printing the decompressed codestream directly
-    int disposalMethod = ((this->mExtensions.GraphicsControl.Packed >> (uint8_t)GCEMask::Disposal) & 0x07);
-    switch (disposalMethod) {
-    case 0:
-        break;
-    case 1:
-        DrawOverImage(rasterData, pixMap, lsd);
-        break;
-    case 2:
-        RestoreCanvasToBG(pixMap, lsd);
-        break;
-    case 3:
-        RestoreToPrevState(pixMap, prevPixMap);
-        break;
-    case 4:
-    case 5:
-    case 6:
-    case 7:
-        break;
-    default:
-        error(Severity::medium, "Image:", "undefined disposal method -", disposalMethod);
-        break;
-    }
-}
-
-void Image::DrawOverImage(std::string* rasterData, std::vector<char>* pixelMap, LogicalScreenDescriptor* lsd)
-{
-    logger.Log(TRACE, "Drawing over image");
-
-    int offset = 0;
-    int currentChar = 0;
-    for (int row = 0; row < this->mDescriptor.Height; row++) {
-        for (int col = 0; col < this->mDescriptor.Width; col++) {
-            if ((size_t)currentChar + 1 <= rasterData->size()) {
-                offset = ((row + this->mDescriptor.Top) * lsd->Width) + (col + this->mDescriptor.Left);
-                pixelMap->at(offset) = rasterData->at(currentChar);
-                currentChar++;
-            }
+            // Unknown extensions still follow the sub block layout so they can be skipped over
+            this->mStream->Read(&nextSize, sizeof(uint8_t));
+            SubBlockReader(this->mStream, nextSize).Skip();
+            break;
         }
     }
 }
 
-void Image::RestoreCanvasToBG(std::vector<char>* pixelMap, LogicalScreenDescriptor* lsd)
-{
-    logger.Log(TRACE, "Restore canvas to background");
-    std::unordered_map<int, std::string> codeTable = LZW::InitializeCodeTable(this->mColorTableSize);
-
-    int offset = 0;
-    for (int row = 0; row < this->mDescriptor.Height; row++ ) {
-        for (int col = 0; col < this->mDescriptor.Left; col++) {
-            offset = ((row + this->mDescriptor.Top) * lsd->Width) + (col + this->mDescriptor.Left);
-            pixelMap->at(offset) = codeTable[lsd->BackgroundColorIndex][0]; 
-        }
-    } 
-}
-
-void Image::RestoreToPrevState(std::vector<char>* pixMap, std::vector<char>* prevPixMap)
-{
-    logger.Log(DEBUG, "Restore canvas to previous state");
-    *pixMap = *prevPixMap;
-}
-
 void Image::PrintDescriptor()
 {
     logger.Log(DEBUG, "------- Image Descriptor -------");
@@ -0,0 +1,293 @@
+#include "kernels.hpp"
+#include "utils/logger.hpp"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace Kernels
+{
+    typedef void (*ExpandFn)(const uint8_t*, size_t, const uint32_t*, uint8_t*);
+    typedef void (*LumaFn)(const uint8_t*, size_t, uint16_t, uint8_t*);
+
+    static void ExpandRGBScalar(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgb)
+    {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t color = palette[indices[i]];
+            rgb[0] = color;
+            rgb[1] = color >> 8;
+            rgb[2] = color >> 16;
+            rgb += 3;
+        }
+    }
+
+    static void LumaBucketsScalar(const uint8_t* rgb, size_t count, uint16_t glyphCount, uint8_t* buckets)
+    {
+        for (size_t i = 0; i < count; i++) {
+            buckets[i] = LumaBucket(rgb[0], rgb[1], rgb[2], glyphCount);
+            rgb += 3;
+        }
+    }
+
+#ifdef KERNELS_X86
+    // Squeeze four 32 bit palette entries down to 12 bytes of RGB
+    __attribute__((target("sse2")))
+    static inline void StoreRGB4(__m128i colors, uint8_t* rgb)
+    {
+        // Pull the odd entries next to the even ones inside of each 64 bit half
+        const __m128i low24 = _mm_set1_epi64x(0x0000000000FFFFFF);
+        __m128i pairs = _mm_or_si128(_mm_and_si128(colors, low24), _mm_slli_epi64(_mm_srli_epi64(colors, 32), 24));
+
+        // Then close the 2 byte gap between the halves
+        const __m128i low48 = _mm_set_epi64x(0, 0x0000FFFFFFFFFFFF);
+        __m128i packed = _mm_or_si128(_mm_and_si128(pairs, low48), _mm_srli_si128(_mm_andnot_si128(low48, pairs), 2));
+
+        _mm_storel_epi64((__m128i*)rgb, packed);
+        uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+        memcpy(rgb + 8, &tail, sizeof(tail));
+    }
+
+    __attribute__((target("sse2")))
+    static void ExpandRGBSSE2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgb)
+    {
+        // SSE2 has no gather, the lookups stay scalar and only the packing is vectorized
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            for (size_t j = 0; j < 16; j += 4) {
+                __m128i colors = _mm_set_epi32(palette[indices[i + j + 3]], palette[indices[i + j + 2]],
+                                               palette[indices[i + j + 1]], palette[indices[i + j]]);
+                StoreRGB4(colors, rgb + (i + j) * 3);
+            }
+        }
+
+        ExpandRGBScalar(indices + i, count - i, palette, rgb + i * 3);
+    }
+
+    // Y = (54R + 183G + 18B + 128) >> 8 and bucket = (Y * glyphCount) >> 8 on 16 bit lanes,
+    // the largest intermediate (255 * 255 + 128) still fits into an unsigned 16 bit lane
+    __attribute__((target("sse2")))
+    static inline __m128i Buckets8(__m128i red, __m128i green, __m128i blue, __m128i glyphs)
+    {
+        __m128i luma = _mm_add_epi16(_mm_mullo_epi16(red, _mm_set1_epi16(54)), _mm_mullo_epi16(green, _mm_set1_epi16(183)));
+        luma = _mm_add_epi16(luma, _mm_mullo_epi16(blue, _mm_set1_epi16(18)));
+        luma = _mm_srli_epi16(_mm_add_epi16(luma, _mm_set1_epi16(128)), 8);
+        return _mm_srli_epi16(_mm_mullo_epi16(luma, glyphs), 8);
+    }
+
+    __attribute__((target("sse2")))
+    static void LumaBucketsSSE2(const uint8_t* rgb, size_t count, uint16_t glyphCount, uint8_t* buckets)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i glyphs = _mm_set1_epi16(glyphCount);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            const uint8_t* src = rgb + i * 3;
+            __m128i a = _mm_loadu_si128((const __m128i*)src);
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+            __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+
+            // Without pshufb the channels are separated by interleaving the bytes of the blocks with
+            // each other, every round triples the distance between neighbouring bytes and after
+            // four rounds the blocks hold all of the reds, greens and blues
+            for (int round = 0; round < 4; round++) {
+                __m128i x = _mm_unpacklo_epi8(a, _mm_srli_si128(b, 8));
+                __m128i y = _mm_unpacklo_epi8(_mm_srli_si128(a, 8), c);
+                __m128i z = _mm_unpacklo_epi8(b, _mm_srli_si128(c, 8));
+                a = x;
+                b = y;
+                c = z;
+            }
+
+            __m128i red = a;
+            __m128i green = b;
+            __m128i blue = c;
+
+            __m128i low = Buckets8(_mm_unpacklo_epi8(red, zero), _mm_unpacklo_epi8(green, zero), _mm_unpacklo_epi8(blue, zero), glyphs);
+            __m128i high = Buckets8(_mm_unpackhi_epi8(red, zero), _mm_unpackhi_epi8(green, zero), _mm_unpackhi_epi8(blue, zero), glyphs);
+            _mm_storeu_si128((__m128i*)(buckets + i), _mm_packus_epi16(low, high));
+        }
+
+        LumaBucketsScalar(rgb + i * 3, count - i, glyphCount, buckets + i);
+    }
+
+    __attribute__((target("avx2")))
+    static void ExpandRGBAVX2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgb)
+    {
+        // Drop the unused fourth byte of every entry, per 128 bit lane 16 bytes become 12
+        const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                              0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i offsets = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(indices + i)));
+            __m256i colors = _mm256_shuffle_epi8(_mm256_i32gather_epi32((const int*)palette, offsets, 4), pack);
+
+            uint8_t* dst = rgb + i * 3;
+            __m128i low = _mm256_castsi256_si128(colors);
+            __m128i high = _mm256_extracti128_si256(colors, 1);
+
+            _mm_storel_epi64((__m128i*)dst, low);
+            uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(low, 8));
+            memcpy(dst + 8, &tail, sizeof(tail));
+
+            _mm_storel_epi64((__m128i*)(dst + 12), high);
+            tail = _mm_cvtsi128_si32(_mm_srli_si128(high, 8));
+            memcpy(dst + 20, &tail, sizeof(tail));
+        }
+
+        ExpandRGBScalar(indices + i, count - i, palette, rgb + i * 3);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i Buckets16(__m256i red, __m256i green, __m256i blue, __m256i glyphs)
+    {
+        __m256i luma = _mm256_add_epi16(_mm256_mullo_epi16(red, _mm256_set1_epi16(54)), _mm256_mullo_epi16(green, _mm256_set1_epi16(183)));
+        luma = _mm256_add_epi16(luma, _mm256_mullo_epi16(blue, _mm256_set1_epi16(18)));
+        luma = _mm256_srli_epi16(_mm256_add_epi16(luma, _mm256_set1_epi16(128)), 8);
+        return _mm256_srli_epi16(_mm256_mullo_epi16(luma, glyphs), 8);
+    }
+
+    __attribute__((target("avx2")))
+    static void LumaBucketsAVX2(const uint8_t* rgb, size_t count, uint16_t glyphCount, uint8_t* buckets)
+    {
+        // Where each channel sits in a run of 16 pixels spread over three 16 byte blocks
+        const __m256i redA   = _mm256_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m256i redB   = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+        const __m256i redC   = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13,
+                                                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+        const __m256i greenA = _mm256_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m256i greenB = _mm256_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+        const __m256i greenC = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14,
+                                                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+        const __m256i blueA  = _mm256_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m256i blueB  = _mm256_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+        const __m256i blueC  = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15,
+                                                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i glyphs = _mm256_set1_epi16(glyphCount);
+
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            // Pixels 0-15 go into the low lane and 16-31 into the high lane
+            const uint8_t* src = rgb + i * 3;
+            __m256i a = _mm256_loadu2_m128i((const __m128i*)(src + 48), (const __m128i*)src);
+            __m256i b = _mm256_loadu2_m128i((const __m128i*)(src + 64), (const __m128i*)(src + 16));
+            __m256i c = _mm256_loadu2_m128i((const __m128i*)(src + 80), (const __m128i*)(src + 32));
+
+            __m256i red = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, redA), _mm256_shuffle_epi8(b, redB)), _mm256_shuffle_epi8(c, redC));
+            __m256i green = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, greenA), _mm256_shuffle_epi8(b, greenB)), _mm256_shuffle_epi8(c, greenC));
+            __m256i blue = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(a, blueA), _mm256_shuffle_epi8(b, blueB)), _mm256_shuffle_epi8(c, blueC));
+
+            // Unpacking and packing both work inside of each lane so the pixel order comes back out as it went in
+            __m256i low = Buckets16(_mm256_unpacklo_epi8(red, zero), _mm256_unpacklo_epi8(green, zero), _mm256_unpacklo_epi8(blue, zero), glyphs);
+            __m256i high = Buckets16(_mm256_unpackhi_epi8(red, zero), _mm256_unpackhi_epi8(green, zero), _mm256_unpackhi_epi8(blue, zero), glyphs);
+            _mm256_storeu_si256((__m256i*)(buckets + i), _mm256_packus_epi16(low, high));
+        }
+
+        LumaBucketsSSE2(rgb + i * 3, count - i, glyphCount, buckets + i);
+    }
+#endif
+
+    static Level SupportedLevel()
+    {
+#ifdef KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Level::AVX2;
+
+        if (__builtin_cpu_supports("sse2"))
+            return Level::SSE2;
+#endif
+        return Level::Scalar;
+    }
+
+    struct Dispatch {
+        Level Active;
+        ExpandFn Expand;
+        LumaFn Luma;
+    };
+
+    static Dispatch Select(Level level)
+    {
+        Level supported = SupportedLevel();
+        if (level > supported)
+            level = supported;
+
+        switch (level) {
+#ifdef KERNELS_X86
+        case Level::AVX2:
+            return {Level::AVX2, ExpandRGBAVX2, LumaBucketsAVX2};
+        case Level::SSE2:
+            return {Level::SSE2, ExpandRGBSSE2, LumaBucketsSSE2};
+#endif
+        default:
+            return {Level::Scalar, ExpandRGBScalar, LumaBucketsScalar};
+        }
+    }
+
+    static Dispatch& Current()
+    {
+        // Picked once on first use, function local statics are initialized thread safely
+        static Dispatch dispatch = [] {
+            Dispatch best = Select(Level::AVX2);
+            logger.Log(DEBUG, "Kernels: Using %s", Name(best.Active));
+            return best;
+        }();
+
+        return dispatch;
+    }
+
+    Level Active()
+    {
+        return Current().Active;
+    }
+
+    const char* Name(Level level)
+    {
+        switch (level) {
+        case Level::AVX2:
+            return "AVX2";
+        case Level::SSE2:
+            return "SSE2";
+        default:
+            return "Scalar";
+        }
+    }
+
+    void SetLevel(Level level)
+    {
+        Current() = Select(level);
+    }
+
+    void PackPalette(const Color* colorTable, uint16_t colorCount, uint32_t* palette)
+    {
+        for (int i = 0; i < 256; i++) {
+            Color color = NULL_COLOR;
+            if (colorTable != nullptr && i < colorCount)
+                color = colorTable[i];
+
+            palette[i] = color.Red | (color.Green << 8) | (color.Blue << 16);
+        }
+    }
+
+    void ExpandRGB(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* rgb)
+    {
+        Current().Expand(indices, count, palette, rgb);
+    }
+
+    void LumaBuckets(const uint8_t* rgb, size_t count, uint16_t glyphCount, uint8_t* buckets)
+    {
+        Current().Luma(rgb, count, glyphCount, buckets);
+    }
+}
@@ -1,96 +1,139 @@
 #include "lzw.hpp"
 #include "utils/logger.hpp"
 #include <stdio.h>
-#include <string>
-#include <math.h>
 
 namespace LZW
 {
-    string Decompress(const ImageDataHeader& imgHeader, const uint8_t colorTableSize, vector<uint8_t> codestream)
+    Decoder::Decoder(const uint8_t minCodeSize, uint8_t* output, const size_t outputSize)
     {
-        if (codestream.size() <= 0)
-            return "";
-
-        logger.Log(DEBUG, "Decompressing stream...");
-
-        unordered_map<int, string> table;
-        string charstream = ""; 
-        table = InitializeCodeTable(colorTableSize);
-
-        int offset, newCode, oldCode, codesize, i;
-        offset = 0, i = 0;
-        codesize = imgHeader.LZWMinimum + 1;
-
-        newCode = (codestream[i] >> offset) & ((int)pow(2, codesize) - 1);
-        offset += codesize;
-
-        // Check for clearcode
-        if (newCode == 4) {
-            logger.Log(DEBUG, "Encountered Clear Code...");
-            table = InitializeCodeTable(colorTableSize);
+        this->mOutput = output;
+        this->mOutputSize = outputSize;
+        this->mWritten = 0;
+
+        // Color indices are at most 8 bits wide so anything outside of 2-8 is a corrupt header
+        this->mMinCodeSize = (minCodeSize < 2) ? 2 : (minCodeSize > 8) ? 8 : minCodeSize;
+        this->mClearCode = 1 << this->mMinCodeSize;
+        this->mEndCode = this->mClearCode + 1;
+
+        this->mBitBuffer = 0;
+        this->mBitCount = 0;
+        this->mFinished = false;
+
+        // Root entries never change after a clear code so they only need to be built once
+        for (int i = 0; i < this->mClearCode; i++) {
+            this->mPrefix[i] = 0;
+            this->mSuffix[i] = (uint8_t)i;
+            this->mFirst[i] = (uint8_t)i;
+            this->mLength[i] = 1;
         }
 
-        newCode = (codestream[i] >> offset) & ((int)pow(2, codesize) - 1);
-        offset += codesize;
-
-        charstream += table[newCode];
-        string s = table[newCode], c = "";
-        c += s[0];
-
-        oldCode = newCode;
+        ResetTable();
+    }
 
-        int count = table.size();
-        while (i < (int)codestream.size() - 1) {
-            if (offset + codesize > 8) {
-                uint16_t tmp = (codestream[i + 1] << 8) | codestream[i];
-                newCode = (tmp >> offset) & ((int)pow(2, codesize) - 1);
-                offset -= 8;
-                i++;
-            } else {
-                newCode = (codestream[i] >> offset) & ((int)pow(2, codesize) - 1);
-            }
+    void Decoder::ResetTable()
+    {
+        this->mNextCode = this->mClearCode + SPECIAL_CODE_COUNT;
+        this->mCodeSize = this->mMinCodeSize + 1;
+        this->mCodeMask = (1 << this->mCodeSize) - 1;
+        this->mPrevCode = -1;
+    }
 
-            offset += codesize;
-            c = "";
+    void Decoder::Emit(const uint16_t code)
+    {
+        size_t end = this->mWritten + this->mLength[code];
+        uint16_t entry = code;
+
+        // Walk past the tail of the entry that would land outside of the output buffer
+        size_t pos = end;
+        for (; pos > this->mOutputSize; pos--)
+            entry = this->mPrefix[entry];
+
+        // Entries are stored back to front so the output is filled in reverse
+        while (pos > this->mWritten) {
+            this->mOutput[--pos] = this->mSuffix[entry];
+            entry = this->mPrefix[entry];
+        }
 
-            // If the code is not in the table
-            if (table.find(newCode) == table.end()) {
-                c += table[oldCode][0];
-                s = table[oldCode] + c;
-            } else {
-                s = table[newCode];
-                c = table[newCode][0];
-            }
+        this->mWritten = (end < this->mOutputSize) ? end : this->mOutputSize;
+    }
 
-            if (table[newCode][0] == char(colorTableSize + 1)) {
-                logger.Log(DEBUG, "Reinitializing Code table...");
-                table = InitializeCodeTable(colorTableSize);
+    void Decoder::Decode(const uint8_t* data, const size_t size)
+    {
+        for (size_t i = 0; i < size && !this->mFinished; i++) {
+            this->mBitBuffer |= (uint32_t)data[i] << this->mBitCount;
+            this->mBitCount += 8;
+
+            while (this->mBitCount >= this->mCodeSize) {
+                uint16_t code = this->mBitBuffer & this->mCodeMask;
+                this->mBitBuffer >>= this->mCodeSize;
+                this->mBitCount -= this->mCodeSize;
+
+                if (code == this->mClearCode) {
+                    ResetTable();
+                    continue;
+                }
+
+                if (code == this->mEndCode) {
+                    logger.Log(DEBUG, "End of information");
+                    this->mFinished = true;
+                    return;
+                }
+
+                // First code after a clear is always a root entry
+                if (this->mPrevCode < 0) {
+                    if (code >= this->mClearCode) {
+                        logger.Log(WARNING, "LZW: Invalid first code [%d]", code);
+                        this->mFinished = true;
+                        return;
+                    }
+
+                    Emit(code);
+                    this->mPrevCode = code;
+                    continue;
+                }
+
+                uint8_t first;
+                if (code < this->mNextCode) {
+                    first = this->mFirst[code];
+                } else if (code == this->mNextCode) {
+                    // KwKwK case, the code is the previous entry followed by its own first index
+                    first = this->mFirst[this->mPrevCode];
+                } else {
+                    logger.Log(WARNING, "LZW: Code [%d] not in table", code);
+                    this->mFinished = true;
+                    return;
+                }
+
+                // The table stops growing once full until the encoder sends a clear code
+                if (this->mNextCode < LZW_TABLE_SIZE) {
+                    this->mPrefix[this->mNextCode] = this->mPrevCode;
+                    this->mSuffix[this->mNextCode] = first;
+                    this->mFirst[this->mNextCode] = this->mFirst[this->mPrevCode];
+                    this->mLength[this->mNextCode] = this->mLength[this->mPrevCode] + 1;
+                    this->mNextCode++;
+
+                    if (this->mNextCode > this->mCodeMask && this->mCodeSize < LZW_MAX_CODE_SIZE) {
+                        this->mCodeSize++;
+                        this->mCodeMask = (1 << this->mCodeSize) - 1;
+                    }
+                }
+
+                Emit(code);
+                this->mPrevCode = code;
             }
-
-            table[count] = table[oldCode] + c;
-            count++;
-            oldCode = newCode;
-
-            charstream += s;
-
-            if ((int)table.size() > (int)pow(2, codesize) - 1)
-                codesize++;
         }
-
-        // printf("%s\n", charstream);
-        return charstream;
     }
 
-    unordered_map<int, string> InitializeCodeTable(const uint8_t colorTableSize)
+    size_t Decompress(const ImageDataHeader& imgHeader, const uint8_t* codestream, const size_t size, uint8_t* output, const size_t outputSize)
     {
-        unordered_map<int, string> table;
+        if (size <= 0)
+            return 0;
 
-        for (int i = 0; i < colorTableSize + SPECIAL_CODE_COUNT; i++) { 
-            string ch = ""; 
-            ch += char(i); 
-            table[i] = ch; 
-        }
+        logger.Log(DEBUG, "Decompressing stream...");
+
+        Decoder decoder(imgHeader.LZWMinimum, output, outputSize);
+        decoder.Decode(codestream, size);
 
-        return table;
+        return decoder.Written();
     }
 }
@@ -0,0 +1,91 @@
+#include "palette.hpp"
+#include "kernels.hpp"
+#include "utils/logger.hpp"
+
+#include <string.h>
+
+const Color* PaletteSet::Intern(const Color* colors, uint16_t count)
+{
+    uint64_t hash = Hash(colors, count);
+
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    auto range = this->mTables.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++) {
+        const Table& table = it->second;
+        if (table.Count == count && memcmp(table.Colors.get(), colors, count * COLOR_SIZE) == 0)
+            return table.Colors.get();
+    }
+
+    Table table = {};
+    table.Count = count;
+    table.Colors.reset(new Color[count]);
+    memcpy(table.Colors.get(), colors, count * COLOR_SIZE);
+
+    logger.Log(DEBUG, "New palette of %d colors (%d distinct)", count, (int)this->mTables.size() + 1);
+    return this->mTables.emplace(hash, std::move(table))->second.Colors.get();
+}
+
+void PaletteSet::Clear()
+{
+    std::lock_guard<std::mutex> lock(this->mMutex);
+    this->mTables.clear();
+}
+
+uint64_t PaletteSet::Hash(const Color* colors, uint16_t count)
+{
+    // FNV-1a over the color bytes, tables are at most 768 bytes and only hashed once per frame
+    const uint8_t* bytes = (const uint8_t*)colors;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < (size_t)count * COLOR_SIZE; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash ^ count;
+}
+
+PaletteCache::PaletteCache()
+    : mKeys(new uint32_t[PALETTE_CACHE_SLOTS]),
+      mEntries(new PaletteEntry[PALETTE_CACHE_SLOTS])
+{
+    memset(this->mKeys.get(), 0xFF, PALETTE_CACHE_SLOTS * sizeof(uint32_t));
+    this->mBuilds = 0;
+}
+
+// Write "\x1b[<layer>;2;r;g;bm" without going through printf, scaled frames miss the cache often enough for it to show
+static uint8_t FormatColor(char* out, char layer, const uint8_t* rgb)
+{
+    uint8_t size = 0;
+    out[size++] = '\x1b';
+    out[size++] = '[';
+    out[size++] = layer;
+    out[size++] = '8';
+    out[size++] = ';';
+    out[size++] = '2';
+
+    for (int channel = 0; channel < COLOR_SIZE; channel++) {
+        uint8_t value = rgb[channel];
+        out[size++] = ';';
+        if (value >= 100)
+            out[size++] = '0' + (value / 100);
+        if (value >= 10)
+            out[size++] = '0' + ((value / 10) % 10);
+        out[size++] = '0' + (value % 10);
+    }
+
+    out[size++] = 'm';
+    return size;
+}
+
+void PaletteCache::Build(uint32_t slot, uint32_t color)
+{
+    uint8_t rgb[COLOR_SIZE] = {(uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color};
+
+    PaletteEntry& entry = this->mEntries[slot];
+    entry.Glyph = CHAR_MAP[Kernels::LumaBucket(rgb[0], rgb[1], rgb[2], CHAR_MAP_SIZE)];
+    entry.ForegroundSize = FormatColor(entry.Sgr, '3', rgb);
+    entry.SgrSize = entry.ForegroundSize + FormatColor(entry.Sgr + entry.ForegroundSize, '4', rgb);
+
+    this->mKeys[slot] = color;
+    this->mBuilds++;
+}
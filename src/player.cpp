@@ -0,0 +1,85 @@
+#include "player.hpp"
+#include "utils/logger.hpp"
+
+#include <chrono>
+
+FramePlayer::FramePlayer(GIF* _gif, size_t _depth)
+    : mRing(_depth)
+{
+    this->mGIF = _gif;
+    this->mRunning = false;
+    this->mFailed = false;
+}
+
+FramePlayer::~FramePlayer()
+{
+    Stop();
+}
+
+void FramePlayer::Start()
+{
+    if (this->mRunning || this->mGIF->FrameCount() == 0)
+        return;
+
+    logger.Log(DEBUG, "Decoding up to %zu frames ahead", this->mRing.Capacity());
+    this->mRunning = true;
+    this->mDecoder = std::thread([this] { Decode(); });
+}
+
+void FramePlayer::Stop()
+{
+    this->mRunning = false;
+    if (this->mDecoder.joinable())
+        this->mDecoder.join();
+}
+
+void FramePlayer::Decode()
+{
+    size_t frameCount = this->mGIF->FrameCount();
+
+    for (size_t index = 0; this->mRunning; index = (index + 1) % frameCount) {
+        PlayerFrame* slot;
+        while ((slot = this->mRing.WriteSlot()) == nullptr) {
+            if (!this->mRunning)
+                return;
+
+            std::this_thread::sleep_for(std::chrono::microseconds(PLAYER_POLL_US));
+        }
+
+        // Copying into the slot reuses its buffer once the ring has gone around once
+        try {
+            slot->Index = index;
+            slot->Pixels = this->mGIF->GetFrame(index);
+        } catch (...) {
+            this->mError = std::current_exception();
+            this->mFailed = true;
+            return;
+        }
+
+        this->mRing.Push();
+    }
+}
+
+const PlayerFrame& FramePlayer::Next()
+{
+    PlayerFrame* frame;
+    while ((frame = this->mRing.ReadSlot()) == nullptr) {
+        // Checked only once the ring is empty so every frame decoded before the error is still shown,
+        // the ring is looked at again since the last frame may have been pushed in between
+        if (this->mFailed) {
+            if ((frame = this->mRing.ReadSlot()) != nullptr)
+                break;
+
+            std::rethrow_exception(this->mError);
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(PLAYER_POLL_US));
+    }
+
+    return *frame;
+}
+
+void FramePlayer::Release()
+{
+    this->mRing.Pop();
+}
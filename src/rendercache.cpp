@@ -0,0 +1,63 @@
+#include "rendercache.hpp"
+#include "utils/logger.hpp"
+
+RenderCache::RenderCache(size_t _capacity)
+{
+    this->mCapacity = _capacity;
+    this->mBytes = 0;
+    this->mCount = 0;
+}
+
+const std::vector<char>* RenderCache::Find(size_t index) const
+{
+    if (index >= this->mCached.size() || !this->mCached[index])
+        return nullptr;
+
+    return &this->mFrames[index];
+}
+
+bool RenderCache::Insert(size_t index, const char* data, size_t size)
+{
+    if (!Enabled())
+        return false;
+
+    if (index < this->mCached.size() && this->mCached[index])
+        return true;
+
+    if (this->mBytes + size > this->mCapacity) {
+        logger.Log(INFO, "Render cache: %zu bytes needed, over the %zu byte limit, rendering live",
+            this->mBytes + size, this->mCapacity);
+
+        Clear();
+        this->mCapacity = 0;
+        return false;
+    }
+
+    if (index >= this->mFrames.size()) {
+        this->mFrames.resize(index + 1);
+        this->mCached.resize(index + 1, false);
+    }
+
+    this->mFrames[index].assign(data, data + size);
+    this->mCached[index] = true;
+    this->mBytes += size;
+    this->mCount++;
+    return true;
+}
+
+void RenderCache::SetCapacity(size_t capacity)
+{
+    this->mCapacity = capacity;
+
+    if (this->mBytes > this->mCapacity)
+        Clear();
+}
+
+void RenderCache::Clear()
+{
+    // Swapping with empty vectors actually gives the memory back
+    std::vector<std::vector<char>>().swap(this->mFrames);
+    std::vector<bool>().swap(this->mCached);
+    this->mBytes = 0;
+    this->mCount = 0;
+}
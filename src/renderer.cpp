@@ -0,0 +1,253 @@
+#include "renderer.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+Renderer::Renderer(uint16_t _width, uint16_t _height, RenderMode _mode, CellMode _cells)
+{
+    this->mWidth = _width;
+    this->mPixelHeight = _height;
+    this->mHeight = (_cells == CellMode::HalfBlock) ? (_height + 1) / 2 : _height;
+    this->mMode = _mode;
+    this->mCells = _cells;
+    this->mLength = 0;
+
+    // Worst case every cell moves the cursor and sets both colors, and every row resets and breaks the line
+    size_t cellSize = CUP_MAX_SIZE + (SGR_MAX_SIZE * 2) + HALF_BLOCK_SIZE;
+    size_t rowSize = strlen(ESC_RESET) + 1;
+    this->mBuffer.resize(strlen(ESC_CURSOR_HOME) + ((size_t)this->mWidth * this->mHeight * cellSize) + ((size_t)this->mHeight * rowSize) + strlen(ESC_RESET));
+
+    this->mLastFrame.resize((size_t)this->mWidth * this->mHeight);
+    Invalidate();
+}
+
+void Renderer::Invalidate()
+{
+    this->mLastFrameValid = false;
+}
+
+bool Renderer::BeginFrame()
+{
+    this->mLength = 0;
+
+    // Only cells that changed since the last frame are drawn in delta mode,
+    // the first frame (or one after Invalidate) always has to be drawn in full
+    bool full = (this->mMode == RenderMode::Full || !this->mLastFrameValid);
+
+    // Redraw over the last frame in place instead of clearing the screen
+    if (full)
+        Append(ESC_CURSOR_HOME, strlen(ESC_CURSOR_HOME));
+
+    return full;
+}
+
+void Renderer::EndRow(bool full, long* cursor)
+{
+    if (full) {
+        Append(ESC_RESET, strlen(ESC_RESET));
+        this->mBuffer[this->mLength++] = '\n';
+    } else {
+        // The cursor is left past the last column, where it ends up next depends on the terminal
+        *cursor = -1;
+    }
+}
+
+void Renderer::Render(const Canvas& frame)
+{
+    if (this->mCells == CellMode::HalfBlock)
+        RenderHalfBlocks(frame.Data(), frame.Stride());
+    else
+        RenderCells(frame.Data(), frame.Stride(), nullptr);
+}
+
+void Renderer::Render(const uint8_t* rgb, const uint8_t* glyphs)
+{
+    size_t stride = (size_t)this->mWidth * COLOR_SIZE;
+    if (this->mCells == CellMode::HalfBlock)
+        RenderHalfBlocks(rgb, stride);
+    else
+        RenderCells(rgb, stride, glyphs);
+}
+
+void Renderer::RenderCells(const uint8_t* rgb, size_t stride, const uint8_t* glyphs)
+{
+    bool full = BeginFrame();
+
+    // Linear position of the cursor inside of the frame, -1 when it is not known
+    long cursor = full ? 0 : -1;
+    int64_t lastColor = -1;
+    const PaletteEntry* entry = nullptr;
+
+    for (int row = 0; row < this->mHeight; row++) {
+        const uint8_t* pixels = rgb + (row * stride);
+
+        for (int col = 0; col < this->mWidth; col++) {
+            size_t i = ((size_t)row * this->mWidth) + col;
+            const uint8_t* cell = pixels + (col * COLOR_SIZE);
+            uint32_t color = (cell[0] << 16) | (cell[1] << 8) | cell[2];
+
+            if (full || this->mLastFrame[i] != color) {
+                this->mLastFrame[i] = color;
+
+                // Only jump when the cell does not directly follow the last one drawn
+                if (cursor != (long)i)
+                    AppendCursor(row, col);
+
+                // Runs of the same color share a single pair of color sequences (and the entry they came from)
+                if (color != lastColor) {
+                    entry = &this->mPalette.Find(color);
+                    Append(entry->Sgr, entry->SgrSize);
+                    lastColor = color;
+                }
+
+                this->mBuffer[this->mLength++] = (glyphs != nullptr) ? CHAR_MAP[glyphs[i]] : entry->Glyph;
+                cursor = i + 1;
+            }
+
+            if (col == this->mWidth - 1) {
+                EndRow(full, &cursor);
+
+                // Full rows end with a reset, delta rows keep their colors across the cursor move
+                if (full)
+                    lastColor = -1;
+            }
+        }
+    }
+
+    Append(ESC_RESET, strlen(ESC_RESET));
+    this->mLastFrameValid = true;
+}
+
+// Marks a cell of the last row of a frame with an odd height, it has no lower pixel
+#define NO_LOWER_PIXEL 0xFFFFFFFF
+
+void Renderer::RenderHalfBlocks(const uint8_t* rgb, size_t stride)
+{
+    bool full = BeginFrame();
+    long cursor = full ? 0 : -1;
+    int64_t lastUpper = -1;
+    int64_t lastLower = -1;
+
+    for (int row = 0; row < this->mHeight; row++) {
+        const uint8_t* upperPixels = rgb + (row * 2 * stride);
+        const uint8_t* lowerPixels = (row * 2 + 1 < this->mPixelHeight) ? upperPixels + stride : nullptr;
+
+        for (int col = 0; col < this->mWidth; col++) {
+            const uint8_t* top = upperPixels + (col * COLOR_SIZE);
+            uint32_t upper = (top[0] << 16) | (top[1] << 8) | top[2];
+
+            uint32_t lower = NO_LOWER_PIXEL;
+            if (lowerPixels != nullptr) {
+                const uint8_t* bottom = lowerPixels + (col * COLOR_SIZE);
+                lower = (bottom[0] << 16) | (bottom[1] << 8) | bottom[2];
+            }
+
+            // Both pixels are compared at once, the cell is only redrawn if either of them changed
+            size_t i = ((size_t)row * this->mWidth) + col;
+            uint64_t pair = ((uint64_t)upper << 32) | lower;
+
+            if (full || this->mLastFrame[i] != pair) {
+                this->mLastFrame[i] = pair;
+
+                if (cursor != (long)i)
+                    AppendCursor(row, col);
+
+                // Foreground and background are tracked on their own, a run where only one
+                // half changes color only needs the sequence for that half
+                if (upper != lastUpper) {
+                    const PaletteEntry& entry = this->mPalette.Find(upper);
+                    Append(entry.Sgr, entry.ForegroundSize);
+                    lastUpper = upper;
+                }
+
+                if (lower != lastLower) {
+                    if (lower == NO_LOWER_PIXEL) {
+                        Append(ESC_DEFAULT_BG, strlen(ESC_DEFAULT_BG));
+                    } else {
+                        const PaletteEntry& entry = this->mPalette.Find(lower);
+                        Append(entry.Sgr + entry.ForegroundSize, entry.SgrSize - entry.ForegroundSize);
+                    }
+
+                    lastLower = lower;
+                }
+
+                Append(HALF_BLOCK, HALF_BLOCK_SIZE);
+                cursor = i + 1;
+            }
+
+            if (col == this->mWidth - 1) {
+                EndRow(full, &cursor);
+
+                if (full) {
+                    lastUpper = -1;
+                    lastLower = -1;
+                }
+            }
+        }
+    }
+
+    Append(ESC_RESET, strlen(ESC_RESET));
+    this->mLastFrameValid = true;
+}
+
+bool Renderer::Flush(int fd)
+{
+    return WriteAll(fd, this->mBuffer.data(), this->mLength);
+}
+
+void Renderer::Clear(int fd)
+{
+    std::string clear = std::string(ESC_HIDE_CURSOR) + ESC_CLEAR_SCREEN + ESC_CURSOR_HOME;
+    WriteAll(fd, clear.data(), clear.size());
+    Invalidate();
+}
+
+bool Renderer::WriteAll(int fd, const char* data, size_t size)
+{
+    size_t written = 0;
+    while (written < size) {
+        ssize_t result = write(fd, data + written, size - written);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        written += result;
+    }
+
+    return true;
+}
+
+void Renderer::Append(const char* str, size_t size)
+{
+    memcpy(this->mBuffer.data() + this->mLength, str, size);
+    this->mLength += size;
+}
+
+void Renderer::AppendNumber(unsigned int value)
+{
+    char digits[10];
+    int count = 0;
+
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0)
+        this->mBuffer[this->mLength++] = digits[--count];
+}
+
+void Renderer::AppendCursor(int row, int col)
+{
+    // Terminal rows and columns start at 1
+    Append("\x1b[", 2);
+    AppendNumber(row + 1);
+    this->mBuffer[this->mLength++] = ';';
+    AppendNumber(col + 1);
+    this->mBuffer[this->mLength++] = 'H';
+}
@@ -0,0 +1,140 @@
+#include "scaler.hpp"
+#include "kernels.hpp"
+#include "utils/logger.hpp"
+
+#include <algorithm>
+
+Scaler::Scaler(uint16_t _srcWidth, uint16_t _srcHeight, uint16_t _dstWidth, uint16_t _dstHeight)
+{
+    this->mSrcWidth = _srcWidth;
+    this->mSrcHeight = _srcHeight;
+
+    // Only downscaling is supported, every cell needs at least one pixel
+    this->mDstWidth = (_dstWidth == 0) ? 1 : (_dstWidth > _srcWidth) ? _srcWidth : _dstWidth;
+    this->mDstHeight = (_dstHeight == 0) ? 1 : (_dstHeight > _srcHeight) ? _srcHeight : _dstHeight;
+
+    // Blocks are whole pixels so every pixel belongs to exactly one cell,
+    // which lets a changed pixel be traced back to the single cell it affects
+    this->mColumnStart.resize(this->mDstWidth + 1);
+    this->mColumnCell.resize(this->mSrcWidth);
+    for (int cell = 0; cell <= this->mDstWidth; cell++)
+        this->mColumnStart[cell] = ((uint32_t)cell * this->mSrcWidth) / this->mDstWidth;
+
+    for (int cell = 0; cell < this->mDstWidth; cell++) {
+        for (int col = this->mColumnStart[cell]; col < this->mColumnStart[cell + 1]; col++)
+            this->mColumnCell[col] = cell;
+    }
+
+    this->mRowStart.resize(this->mDstHeight + 1);
+    this->mRowCell.resize(this->mSrcHeight);
+    for (int cell = 0; cell <= this->mDstHeight; cell++)
+        this->mRowStart[cell] = ((uint32_t)cell * this->mSrcHeight) / this->mDstHeight;
+
+    for (int cell = 0; cell < this->mDstHeight; cell++) {
+        for (int row = this->mRowStart[cell]; row < this->mRowStart[cell + 1]; row++)
+            this->mRowCell[row] = cell;
+    }
+
+    this->mRGB.resize((size_t)this->mDstWidth * this->mDstHeight * COLOR_SIZE);
+    this->mGlyphs.resize((size_t)this->mDstWidth * this->mDstHeight);
+    this->mSums.resize((size_t)this->mDstWidth * COLOR_SIZE);
+    this->mLastFrame.ResizeRGB(this->mSrcWidth, this->mSrcHeight, NULL_COLOR);
+    Invalidate();
+
+    logger.Log(DEBUG, "Scaling %dx%d down to %dx%d cells", _srcWidth, _srcHeight, this->mDstWidth, this->mDstHeight);
+}
+
+void Scaler::Fit(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxColumns, uint16_t maxRows, float cellAspect,
+                 uint16_t* dstWidth, uint16_t* dstHeight)
+{
+    if (cellAspect <= 0)
+        cellAspect = 1;
+
+    // A picture drawn one cell per pixel would be cellAspect times too tall
+    float scale = 1;
+    float rows = srcHeight / cellAspect;
+
+    if (maxColumns > 0 && srcWidth * scale > maxColumns)
+        scale = (float)maxColumns / srcWidth;
+
+    if (maxRows > 0 && rows * scale > maxRows)
+        scale = (float)maxRows / rows;
+
+    int width = (int)(srcWidth * scale);
+    int height = (int)(rows * scale);
+
+    *dstWidth = (width < 1) ? 1 : (width > srcWidth) ? srcWidth : width;
+    *dstHeight = (height < 1) ? 1 : (height > srcHeight) ? srcHeight : height;
+}
+
+void Scaler::Invalidate()
+{
+    this->mValid = false;
+}
+
+Rect Scaler::Scale(const Canvas& frame)
+{
+    Rect dirty = {0, 0, this->mSrcWidth, this->mSrcHeight};
+    if (this->mValid)
+        dirty = frame.Diff(this->mLastFrame);
+
+    if (dirty.Empty())
+        return {};
+
+    this->mLastFrame.CopyRect(frame, dirty);
+    this->mValid = true;
+
+    // Every cell a changed pixel falls into has to be averaged again
+    uint16_t left = this->mColumnCell[dirty.Left];
+    uint16_t right = this->mColumnCell[dirty.Left + dirty.Width - 1];
+    uint16_t top = this->mRowCell[dirty.Top];
+    uint16_t bottom = this->mRowCell[dirty.Top + dirty.Height - 1];
+
+    Rect cells = {left, top, (uint16_t)(right - left + 1), (uint16_t)(bottom - top + 1)};
+    FilterCells(frame, cells);
+    return cells;
+}
+
+void Scaler::FilterCells(const Canvas& frame, const Rect& cells)
+{
+    // Each source row adds into the sums of its row of cells before they are averaged
+    uint32_t* sums = this->mSums.data();
+    size_t sumCount = (size_t)cells.Width * COLOR_SIZE;
+
+    for (int cellRow = cells.Top; cellRow < cells.Top + cells.Height; cellRow++) {
+        std::fill(sums, sums + sumCount, 0);
+        int rowStart = this->mRowStart[cellRow];
+        int rowEnd = this->mRowStart[cellRow + 1];
+
+        for (int row = rowStart; row < rowEnd; row++) {
+            const uint8_t* pixels = frame.Row(row);
+            uint32_t* sum = sums;
+
+            for (int cellCol = cells.Left; cellCol < cells.Left + cells.Width; cellCol++) {
+                const uint8_t* pixel = pixels + (this->mColumnStart[cellCol] * COLOR_SIZE);
+                for (int col = this->mColumnStart[cellCol]; col < this->mColumnStart[cellCol + 1]; col++) {
+                    sum[0] += pixel[0];
+                    sum[1] += pixel[1];
+                    sum[2] += pixel[2];
+                    pixel += COLOR_SIZE;
+                }
+
+                sum += COLOR_SIZE;
+            }
+        }
+
+        size_t offset = ((size_t)cellRow * this->mDstWidth) + cells.Left;
+        uint8_t* rgb = this->mRGB.data() + (offset * COLOR_SIZE);
+        const uint32_t* sum = sums;
+        for (int cellCol = cells.Left; cellCol < cells.Left + cells.Width; cellCol++) {
+            uint32_t area = (uint32_t)(rowEnd - rowStart) * (this->mColumnStart[cellCol + 1] - this->mColumnStart[cellCol]);
+            rgb[0] = (sum[0] + area / 2) / area;
+            rgb[1] = (sum[1] + area / 2) / area;
+            rgb[2] = (sum[2] + area / 2) / area;
+            rgb += COLOR_SIZE;
+            sum += COLOR_SIZE;
+        }
+
+        Kernels::LumaBuckets(this->mRGB.data() + (offset * COLOR_SIZE), cells.Width, CHAR_MAP_SIZE, this->mGlyphs.data() + offset);
+    }
+}
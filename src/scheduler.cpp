@@ -0,0 +1,71 @@
+#include "scheduler.hpp"
+#include "utils/logger.hpp"
+
+#include <thread>
+
+FrameScheduler::FrameScheduler()
+{
+    Start();
+}
+
+void FrameScheduler::Start()
+{
+    this->mStart = Clock::now();
+    this->mFrameDue = this->mStart;
+    this->mFrameEnd = this->mStart;
+    this->mJitterTotalMs = 0;
+    this->mStats = {};
+}
+
+bool FrameScheduler::Begin(uint32_t delayMs)
+{
+    Clock::time_point now = Clock::now();
+
+    // Way behind, skipping ahead frame by frame would only show a frozen picture
+    if (now - this->mFrameDue > std::chrono::milliseconds(SCHEDULER_RESYNC_MS)) {
+        logger.Log(DEBUG, "Scheduler: %.0fms behind, resyncing",
+            std::chrono::duration<double, std::milli>(now - this->mFrameDue).count());
+        this->mFrameDue = now;
+    }
+
+    this->mFrameEnd = this->mFrameDue + std::chrono::milliseconds(delayMs);
+
+    // The frame would already be gone by the time it was drawn, the next one is shown instead
+    if (delayMs > 0 && now >= this->mFrameEnd) {
+        this->mFrameDue = this->mFrameEnd;
+        this->mStats.FramesDropped++;
+        return false;
+    }
+
+    double jitter = std::chrono::duration<double, std::milli>(now - this->mFrameDue).count();
+    if (jitter < 0)
+        jitter = -jitter;
+
+    this->mJitterTotalMs += jitter;
+    if (jitter > this->mStats.MaxJitterMs)
+        this->mStats.MaxJitterMs = jitter;
+
+    this->mStats.FramesShown++;
+    return true;
+}
+
+void FrameScheduler::Wait()
+{
+    // Deadlines are absolute, time spent drawing is already part of the wait
+    std::this_thread::sleep_until(this->mFrameEnd);
+    this->mFrameDue = this->mFrameEnd;
+}
+
+const PlaybackStats& FrameScheduler::Stats() const
+{
+    this->mStats.Seconds = std::chrono::duration<double>(Clock::now() - this->mStart).count();
+    this->mStats.MeanJitterMs = (this->mStats.FramesShown > 0) ? this->mJitterTotalMs / this->mStats.FramesShown : 0;
+    return this->mStats;
+}
+
+void FrameScheduler::Report() const
+{
+    const PlaybackStats& stats = Stats();
+    logger.Log(INFO, "Playback: %zu frames in %.2fs (%.1f fps), %zu dropped, jitter %.2fms mean / %.2fms max",
+        stats.FramesShown, stats.Seconds, stats.Fps(), stats.FramesDropped, stats.MeanJitterMs, stats.MaxJitterMs);
+}
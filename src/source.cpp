@@ -1,36 +1,235 @@
 #include "catch_amalgamated.hpp"
+#include "batch.hpp"
 #include "display.hpp"
+#include "export.hpp"
 #include "gif.hpp"
 #include "utils/error.hpp"
 #include "utils/logger.hpp"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Largest values the numeric options accept, anything past these is a typo rather than a setting
+#define MAX_THREADS       256
+#define MAX_AHEAD_FRAMES  1024
+#define MAX_CACHE_MB      (64 * 1024)
+#define MAX_LOOPS         UINT16_MAX
+#define MAX_CELLS         UINT16_MAX
+
 /*
     The current version of this converter only works on gif89a not gif87a
     (for the most part). I am not doing to correct reading standard for v87a
     application extensions. Maybe in the future I will add more compatibility
 */
 
-Logger logger;
-int main(int argc, char **argv) {
-  // Initialize logger
-  logger = new Logger("logs/", "info");
+void PrintFrameTable(const FrameIndex &index) {
+  fprintf(stdout, "Frames: %zu\n", index.Count());
+  fprintf(stdout, "Duration: %lums\n", (unsigned long)index.TotalDuration());
+  fprintf(stdout, "%6s %10s %5s %5s %5s %5s %6s %8s %11s %3s\n", "frame",
+          "offset", "left", "top", "width", "height", "delay", "disposal",
+          "transparent", "lct");
+
+  for (size_t i = 0; i < index.Count(); i++) {
+    const FrameInfo &frame = index[i];
+    fprintf(stdout, "%6zu %10zu %5d %5d %5d %5d %6d %8d %11s %3s\n", i,
+            frame.Offset, frame.Left, frame.Top, frame.Width, frame.Height,
+            frame.DelayTime * 10, frame.Disposal,
+            frame.Transparent ? "yes" : "no",
+            frame.LocalColorTable ? "yes" : "no");
+  }
+}
+
+/**
+ * Parse the value of a numeric option, atoi would quietly turn "-1" into a huge size
+ *
+ * @param flag - Option the value belongs to, used in the error message
+ * @param value - Text given after the option
+ * @param max - Largest value accepted
+ * @return The parsed value
+ */
+static unsigned long ParseCount(const char *flag, const char *value, unsigned long max) {
+  // strtoul accepts a sign and negates the result, so only plain digits are let through
+  char *end = nullptr;
+  errno = 0;
+  unsigned long count = (value[0] >= '0' && value[0] <= '9') ? strtoul(value, &end, 10) : 0;
+  if (end == nullptr || *end != '\0' || errno == ERANGE || count > max)
+    error(Severity::high, "Usage:", flag, "expects a whole number from 0 to", max, "but got", value);
+
+  return count;
+}
+
+static int Run(int argc, char **argv) {
+  // Initialize logger, the library keeps quiet unless the program asks for output
+  logger.SetConsoleOut(true);
+  logger.Open("logs/", "info");
   logger.EnableTracing();
 
-  if (argc < 2)
-    error(Severity::high, "Usage:", "./bin/gif2Ascii <filepath>");
+  std::vector<const char *> inputs;
+  const char *batchDir = nullptr;
+  const char *exportPath = nullptr;
+  const char *exportDir = nullptr;
+  unsigned int loops = 1;
+  uint16_t columns = 0;
+  uint16_t rows = 0;
+  bool timing = false;
+  unsigned int threads = 1;
+  float cellAspect = DEFAULT_CELL_ASPECT;
+  bool lazy = false;
+  bool info = false;
+  bool progressive = false;
+  size_t ahead = 0;
+  size_t cacheMB = 0;
+  CellMode cells = CellMode::Glyph;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      threads = ParseCount("-j", argv[++i], MAX_THREADS);
+    else if (strcmp(argv[i], "--lazy") == 0)
+      lazy = true;
+    else if (strcmp(argv[i], "--ahead") == 0 && i + 1 < argc)
+      ahead = ParseCount("--ahead", argv[++i], MAX_AHEAD_FRAMES);
+    else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+      cacheMB = ParseCount("--cache", argv[++i], MAX_CACHE_MB);
+    else if (strcmp(argv[i], "--info") == 0)
+      info = true;
+    else if (strcmp(argv[i], "--progressive") == 0)
+      progressive = true;
+    else if (strcmp(argv[i], "--aspect") == 0 && i + 1 < argc)
+      cellAspect = atof(argv[++i]);
+    else if (strcmp(argv[i], "--half") == 0)
+      cells = CellMode::HalfBlock;
+    else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+      batchDir = argv[++i];
+    else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc)
+      exportPath = argv[++i];
+    else if (strcmp(argv[i], "--export-frames") == 0 && i + 1 < argc)
+      exportDir = argv[++i];
+    else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+      loops = ParseCount("--loops", argv[++i], MAX_LOOPS);
+    else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc)
+      columns = ParseCount("--columns", argv[++i], MAX_CELLS);
+    else if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+      rows = ParseCount("--rows", argv[++i], MAX_CELLS);
+    else if (strcmp(argv[i], "--timing") == 0)
+      timing = true;
+    else
+      inputs.push_back(argv[i]);
+  }
+
+  if (inputs.empty())
+    error(Severity::high, "Usage:",
+          "./bin/gif2Ascii [-j threads] [--lazy] [--ahead frames] [--cache MB] [--progressive] [--info] [--aspect ratio] [--half] <filepath>\n"
+          "       ./bin/gif2Ascii --batch <outdir> [-j threads] [--half] <files or directories...>\n"
+          "       ./bin/gif2Ascii --export <file or -> [--loops n] [--timing] [--cache MB] [--columns n] [--rows n] [-j threads] [--half] <filepath>\n"
+          "       ./bin/gif2Ascii --export-frames <outdir> [--columns n] [--rows n] [-j threads] [--half] <filepath>");
+
+  // Keep the console quiet while a stream goes to stdout, the log file still gets everything
+  bool exportToStdout = (exportPath != nullptr && strcmp(exportPath, "-") == 0);
+  if (exportToStdout)
+    logger.SetConsoleOut(false);
+
+  // Batch mode converts every input into a file, -j is the number of files converted at once.
+  // Only the report goes to the console, the log file still gets everything
+  if (batchDir != nullptr) {
+    logger.SetConsoleOut(false);
+
+    BatchConverter batch = BatchConverter(batchDir, threads, RenderMode::Delta, cells);
+    for (const char *input : inputs)
+      batch.Add(input);
+
+    size_t failed = batch.Run();
+    logger.Close();
+    return (failed == 0) ? 0 : 1;
+  }
 
   // Attempt to load GIF
-  GIF gif = GIF(argv[1]);
+  const char *filepath = inputs.back();
+  GIF gif = GIF(filepath);
+
+  // Only print the frame table, no pixels need to be decoded for it
+  if (info) {
+    gif.Scan();
+    PrintFrameTable(gif.Index());
+    logger.Close();
+    return 0;
+  }
+
+  gif.SetDecodeThreads(threads);
+  if (lazy)
+    gif.SetLazy();
+
+  // Previews are drawn while a frame is decoded on the display thread, a GIF decoded up front
+  // (or by the decode ahead thread) is done before anything is drawn
+  if (progressive && ahead > 0)
+    logger.Log(WARNING, "--progressive has no effect with --ahead, frames are decoded on another thread");
+  else if (progressive && !lazy && exportPath == nullptr && exportDir == nullptr)
+    gif.SetLazy();
+
+  // Decoding ahead streams the frames from the file during playback, frames are only
+  // decoded in order so the decoder needs the frame before the one it is on and a single keyframe
+  if (ahead > 0)
+    gif.SetLazy(1, SIZE_MAX);
+
   gif.Read();
 
-  // Setup drawing procdure and display frame data
-  GifDisplay display = GifDisplay(&gif);
+  // Export renders every frame into files as fast as it can instead of playing them
+  if (exportPath != nullptr || exportDir != nullptr) {
+    ExportOptions options;
+    options.Loops = loops;
+    options.Timing = timing;
+    options.Cells = cells;
+    options.CellAspect = cellAspect;
+    options.Columns = columns;
+    options.Rows = rows;
+    options.CacheBytes = cacheMB * 1024 * 1024;
+
+    GifExporter exporter = GifExporter(&gif, options);
+    bool success = true;
+
+    if (exportDir != nullptr)
+      success = exporter.WriteFrames(exportDir);
+
+    if (exportPath != nullptr) {
+      int fd = exportToStdout ? STDOUT_FILENO : open(exportPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+        error(Severity::high, "Export:", "Could not create", exportPath);
 
-  // Background
-  fprintf(stdout, "\x1b[38;2;%d;%d;%dm", 255, 0, 0);
+      success = exporter.WriteStream(fd) && success;
+      if (!exportToStdout)
+        close(fd);
+    }
 
-  // display.LoopFrames();
+    logger.Close();
+    return success ? 0 : 1;
+  }
+
+  // Frames decoded during playback would log over the animation, the log file still gets everything
+  logger.SetConsoleOut(false);
+
+  // Setup drawing procdure and display frame data
+  GifDisplay display = GifDisplay(&gif, RenderMode::Delta, cellAspect, cells);
+  display.SetDecodeAhead(ahead);
+  display.SetRenderCache(cacheMB * 1024 * 1024);
+  display.SetProgressive(progressive);
+
+  // Plays until interrupted, SIGINT restores the terminal and ends the process
+  display.LoopFrames();
 
   logger.Close();
   return 0;
 }
+
+int main(int argc, char **argv) {
+  // Errors are thrown by the decoder, the process ends with their severity as its status
+  try {
+    return Run(argc, argv);
+  } catch (const GifError &e) {
+    logger.Close();
+    return (int)e.Level();
+  }
+}
@@ -0,0 +1,166 @@
+#include "stream.hpp"
+#include "utils/logger.hpp"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ByteStream::ByteStream(const char* _filepath, StreamBackend _backend)
+{
+    this->mOpen = false;
+    this->mFile = NULL;
+    this->mData = nullptr;
+    this->mPos = 0;
+    this->mSize = 0;
+
+    if (_backend != StreamBackend::Stdio && Map(_filepath)) {
+        this->mBackend = StreamBackend::Mapped;
+        this->mOpen = true;
+        return;
+    }
+
+    this->mBackend = StreamBackend::Stdio;
+    this->mOpen = OpenFile(_filepath);
+}
+
+ByteStream::ByteStream(const uint8_t* _data, size_t _size)
+{
+    this->mBackend = StreamBackend::Memory;
+    this->mOpen = (_data != nullptr);
+    this->mFile = NULL;
+    this->mData = _data;
+    this->mPos = 0;
+    this->mSize = _size;
+}
+
+ByteStream::~ByteStream()
+{
+    if (this->mBackend == StreamBackend::Mapped && this->mData != nullptr)
+        munmap((void*)this->mData, this->mSize);
+
+    if (this->mFile != NULL)
+        fclose(this->mFile);
+}
+
+bool ByteStream::Map(const char* _filepath)
+{
+    int fd = open(_filepath, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping holds its own reference to the file
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        logger.Log(WARNING, "Failed to map [%s], falling back to stdio", _filepath);
+        return false;
+    }
+
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    this->mData = (const uint8_t*)data;
+    this->mSize = st.st_size;
+    logger.Log(DEBUG, "Mapped [%s]", _filepath);
+    return true;
+}
+
+bool ByteStream::OpenFile(const char* _filepath)
+{
+    this->mFile = fopen(_filepath, "rb");
+    if (this->mFile == NULL)
+        return false;
+
+    // Get the file size and restore the file pointer back to position 0
+    fseek(this->mFile, 0, SEEK_END);
+    this->mSize = ftell(this->mFile);
+    rewind(this->mFile);
+
+    return true;
+}
+
+size_t ByteStream::Read(void* dst, size_t size)
+{
+    if (this->mBackend == StreamBackend::Stdio)
+        return fread(dst, sizeof(uint8_t), size, this->mFile);
+
+    size_t left = this->mSize - this->mPos;
+    if (size > left)
+        size = left;
+
+    memcpy(dst, this->mData + this->mPos, size);
+    this->mPos += size;
+    return size;
+}
+
+const uint8_t* ByteStream::View(size_t size)
+{
+    if (this->mBackend == StreamBackend::Stdio) {
+        if (this->mScratch.size() < size)
+            this->mScratch.resize(size);
+
+        if (fread(this->mScratch.data(), sizeof(uint8_t), size, this->mFile) != size)
+            return nullptr;
+
+        return this->mScratch.data();
+    }
+
+    if (size > this->mSize - this->mPos) {
+        this->mPos = this->mSize;
+        return nullptr;
+    }
+
+    const uint8_t* view = this->mData + this->mPos;
+    this->mPos += size;
+    return view;
+}
+
+int ByteStream::Peek()
+{
+    if (this->mBackend == StreamBackend::Stdio) {
+        int c = fgetc(this->mFile);
+        if (c != EOF)
+            ungetc(c, this->mFile);
+
+        return (c == EOF) ? -1 : c;
+    }
+
+    return (this->mPos < this->mSize) ? this->mData[this->mPos] : -1;
+}
+
+void ByteStream::Skip(size_t size)
+{
+    if (this->mBackend == StreamBackend::Stdio) {
+        fseek(this->mFile, size, SEEK_CUR);
+        return;
+    }
+
+    this->mPos = (size > this->mSize - this->mPos) ? this->mSize : this->mPos + size;
+}
+
+void ByteStream::Seek(size_t position)
+{
+    if (this->mBackend == StreamBackend::Stdio) {
+        fseek(this->mFile, position, SEEK_SET);
+        return;
+    }
+
+    this->mPos = (position > this->mSize) ? this->mSize : position;
+}
+
+size_t ByteStream::Tell() const
+{
+    if (this->mBackend == StreamBackend::Stdio)
+        return ftell(this->mFile);
+
+    return this->mPos;
+}
@@ -0,0 +1,41 @@
+#include "subblock.hpp"
+#include "utils/logger.hpp"
+
+SubBlockReader::SubBlockReader(ByteStream* _stream, uint8_t _firstSize)
+{
+    this->mStream = _stream;
+    this->mData = nullptr;
+    this->mNextSize = _firstSize;
+    this->mTerminated = (_firstSize == 0);
+}
+
+uint8_t SubBlockReader::Next()
+{
+    if (this->mTerminated)
+        return 0;
+
+    uint8_t size = this->mNextSize;
+
+    // View the block and the size of the one following it in a single call
+    this->mData = this->mStream->View(size + 1);
+    if (this->mData == nullptr) {
+        logger.Log(WARNING, "Sub block ended early, expected [%d] bytes", size + 1);
+        this->mTerminated = true;
+        return 0;
+    }
+
+    this->mNextSize = this->mData[size];
+    this->mTerminated = (this->mNextSize == 0);
+
+    return size;
+}
+
+void SubBlockReader::Skip()
+{
+    while (!this->mTerminated) {
+        this->mStream->Skip(this->mNextSize);
+
+        if (this->mStream->Read(&this->mNextSize, sizeof(uint8_t)) != 1 || this->mNextSize == 0)
+            this->mTerminated = true;
+    }
+}